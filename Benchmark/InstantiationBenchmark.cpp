@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+    InstantiationBenchmark.cpp - Construct/destroy cost of the plugin processor
+
+    Mimics a host loading a large template: creates N processors, prepares them,
+    then destroys them, timing each phase. Usage: SpectralImager3D_Benchmark [N]
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/PluginProcessor.h"
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    template <typename Fn>
+    double timeMs(Fn&& fn)
+    {
+        auto start = juce::Time::getHighResolutionTicks();
+        fn();
+        return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0;
+    }
+
+    void report(const char* phase, double ms, int count)
+    {
+        std::printf("%-12s %9.3f ms total  %8.4f ms/instance\n", phase, ms, ms / count);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInit;
+
+    const int count = argc > 1 ? juce::jmax(1, juce::String(argv[1]).getIntValue()) : 60;
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 512;
+
+    std::vector<std::unique_ptr<SpectralImagerAudioProcessor>> instances;
+    instances.reserve(static_cast<size_t>(count));
+
+    // Scan-style: construct and destroy without ever preparing
+    double scanMs = timeMs([&] {
+        for (int i = 0; i < count; ++i)
+            std::make_unique<SpectralImagerAudioProcessor>().reset();
+    });
+
+    // Template load: all instances alive at once, then prepared, then torn down
+    double constructMs = timeMs([&] {
+        for (int i = 0; i < count; ++i)
+            instances.push_back(std::make_unique<SpectralImagerAudioProcessor>());
+    });
+    double prepareMs = timeMs([&] {
+        for (auto& p : instances)
+            p->prepareToPlay(sampleRate, blockSize);
+    });
+    double destroyMs = timeMs([&] { instances.clear(); });
+
+    std::printf("%d instances\n", count);
+    report("scan", scanMs, count);
+    report("construct", constructMs, count);
+    report("prepare", prepareMs, count);
+    report("destroy", destroyMs, count);
+    return 0;
+}
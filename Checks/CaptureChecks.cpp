@@ -0,0 +1,259 @@
+/*
+  ==============================================================================
+    CaptureChecks.cpp - Checks for the capture query and session diff paths
+
+    Writes small synthetic captures to a temp folder and runs the conflict query,
+    index validation and diff alignment over them. Exits non-zero on any failure.
+    Usage: SpectralImager3D_Checks
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../Source/SessionDiff.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace
+{
+    int failures = 0;
+    int checks = 0;
+
+    void check(bool ok, const char* what, int line)
+    {
+        ++checks;
+        if (ok) return;
+        ++failures;
+        std::printf("FAIL line %d: %s\n", line, what);
+    }
+
+    #define CHECK(cond) check((cond), #cond, __LINE__)
+
+    constexpr int kTestBands = 48;
+    constexpr float kLoudDb = -10.0f, kQuietDb = -60.0f;
+
+    void setLevel(CaptureFrame& f, size_t track, float db)
+    {
+        std::array<float, kMaxBands> levels{};
+        std::fill(levels.begin(), levels.end(), juce::Decibels::decibelsToGain(db, -200.0f));
+        f.setTrack(track, kTestBands, levels.data(), levels.data());
+    }
+
+    using LevelFn = std::function<float(int frame, size_t track)>;
+
+    // Slots 0 and 1 active with every band at levelDb(frame, slot). Leaving it
+    // unfinished skips close(), as a recording cut short would.
+    void writeCapture(const juce::File& file, int numFrames, const LevelFn& levelDb, bool finish = true)
+    {
+        CaptureWriter writer;
+        writer.open(file);
+        CaptureFrame f;
+        for (int i = 0; i < numFrames; ++i)
+        {
+            f.timeMs = static_cast<uint32_t>(i * 1000 / CaptureFormat::kFrameRateHz);
+            setLevel(f, 0, levelDb(i, 0));
+            setLevel(f, 1, levelDb(i, 1));
+            writer.write(f);
+        }
+        if (finish) writer.close();
+    }
+
+    // Slot 0 loud throughout, slot 1 loud on the given inclusive frame ranges
+    LevelFn loudOn(std::vector<std::pair<int, int>> ranges)
+    {
+        return [ranges](int frame, size_t track) {
+            if (track == 0) return kLoudDb;
+            for (auto [first, last] : ranges)
+                if (frame >= first && frame <= last) return kLoudDb;
+            return kQuietDb;
+        };
+    }
+
+    bool sameHits(const std::vector<ConflictHit>& hits, std::vector<std::pair<int64_t, int64_t>> expected)
+    {
+        if (hits.size() != expected.size()) return false;
+        for (size_t i = 0; i < hits.size(); ++i)
+            if (hits[i].startFrame != expected[i].first || hits[i].endFrame != expected[i].second)
+                return false;
+        return true;
+    }
+
+    void checkHitBoundaries(const juce::File& dir)
+    {
+        auto file = dir.getChildFile("hits" + CaptureFormat::getFileExtension());
+        writeCapture(file, 100, loudOn({ { 0, 0 }, { 25, 34 }, { 99, 99 } }));
+
+        CaptureIndex index;
+        CHECK(index.load(file));
+
+        ConflictQuery q;
+        auto hits = index.findOverlaps(q);
+        CHECK(sameHits(hits, { { 0, 0 }, { 25, 34 }, { 99, 99 } }));
+        if (hits.size() == 3)
+        {
+            CHECK(hits[1].startMs == 2500 && hits[1].endMs == 3400);
+            CHECK(hits[2].startMs == 9900 && hits[2].endMs == 9900);
+        }
+
+        // Reversed bounds ask the same question
+        auto swapped = q;
+        std::swap(swapped.minHz, swapped.maxHz);
+        CHECK(sameHits(index.findOverlaps(swapped), { { 0, 0 }, { 25, 34 }, { 99, 99 } }));
+
+        // A track can't conflict with itself, though slot 0 alone is loud everywhere
+        auto self = q;
+        self.trackB = self.trackA;
+        CHECK(index.findOverlaps(self).empty());
+
+        // Above the loud level nothing matches
+        auto strict = q;
+        strict.thresholdDb = kLoudDb + 1.0f;
+        CHECK(index.findOverlaps(strict).empty());
+    }
+
+    void checkMerging(const juce::File& dir)
+    {
+        auto file = dir.getChildFile("merge" + CaptureFormat::getFileExtension());
+        // Gaps of 7, 17, 10 (= mergeGapFrames), 14 and 11 (one past it) frames
+        writeCapture(file, 120, loudOn({ { 10, 12 }, { 20, 22 }, { 40, 42 }, { 53, 55 }, { 70, 72 }, { 84, 86 } }));
+
+        CaptureIndex index;
+        CHECK(index.load(file));
+
+        ConflictQuery q;
+        CHECK(q.mergeGapFrames == 10);
+        CHECK(sameHits(index.findOverlaps(q), { { 10, 22 }, { 40, 55 }, { 70, 72 }, { 84, 86 } }));
+
+        q.mergeGapFrames = 0;
+        CHECK(sameHits(index.findOverlaps(q),
+                       { { 10, 12 }, { 20, 22 }, { 40, 42 }, { 53, 55 }, { 70, 72 }, { 84, 86 } }));
+    }
+
+    void checkIndexValidation(const juce::File& dir)
+    {
+        // Recording cut short: the index on disk has no frame count and misses the last block
+        auto cut = dir.getChildFile("cut" + CaptureFormat::getFileExtension());
+        writeCapture(cut, 105, loudOn({ { 101, 103 } }), false);
+        {
+            CaptureIndex index;
+            CHECK(index.load(cut));
+            CHECK(sameHits(index.findOverlaps({}), { { 101, 103 } }));
+        }
+
+        // Capture replaced while an index of the old one stayed behind
+        auto replaced = dir.getChildFile("replaced" + CaptureFormat::getFileExtension());
+        auto staleIndex = dir.getChildFile("stale.si3didx");
+        writeCapture(replaced, 100, loudOn({}));
+        CHECK(CaptureIndexFormat::fileFor(replaced).copyFileTo(staleIndex));
+        writeCapture(replaced, 150, loudOn({ { 120, 125 } }));
+        CHECK(staleIndex.copyFileTo(CaptureIndexFormat::fileFor(replaced)));
+        {
+            CaptureIndex index;
+            CHECK(index.load(replaced));
+            CHECK(sameHits(index.findOverlaps({}), { { 120, 125 } }));
+        }
+
+        // Same frame count but the index is gone
+        CHECK(CaptureIndexFormat::fileFor(replaced).deleteFile());
+        {
+            CaptureIndex index;
+            CHECK(index.load(replaced));
+            CHECK(sameHits(index.findOverlaps({}), { { 120, 125 } }));
+        }
+    }
+
+    void checkCorruptFrames(const juce::File& dir)
+    {
+        auto file = dir.getChildFile("corrupt" + CaptureFormat::getFileExtension());
+        writeCapture(file, 10, loudOn({}));
+        {
+            juce::FileOutputStream out(file);
+            CHECK(out.setPosition(CaptureFormat::kHeaderBytes + 3 * CaptureFormat::kFrameBytes + 4));
+            out.writeByte(static_cast<char>(kMaxBands + 1));
+        }
+
+        CaptureReader reader;
+        CHECK(reader.open(file));
+        CaptureFrame f;
+        int framesRead = 0;
+        while (reader.read(f)) ++framesRead;
+        CHECK(framesRead == 3);
+    }
+
+    void checkAlignment(const juce::File& dir)
+    {
+        // B is A from frame 37 on, so energy alignment should find that offset and
+        // see no difference once lined up
+        constexpr int kOffset = 37;
+        std::vector<float> envelope(400);
+        juce::Random random(1234);
+        for (auto& db : envelope)
+            db = static_cast<float>(-60 + random.nextInt(51));
+
+        auto fileA = dir.getChildFile("alignA" + CaptureFormat::getFileExtension());
+        auto fileB = dir.getChildFile("alignB" + CaptureFormat::getFileExtension());
+        writeCapture(fileA, 400, [&](int frame, size_t) { return envelope[static_cast<size_t>(frame)]; });
+        writeCapture(fileB, 300, [&](int frame, size_t) { return envelope[static_cast<size_t>(frame + kOffset)]; });
+
+        SessionDiffResult result;
+        CHECK(SessionDiff::compute(fileA, fileB, SessionDiff::Alignment::EnergyCorrelation, result));
+        CHECK(result.offsetFrames == kOffset);
+        CHECK(result.framesCompared == 300);
+        CHECK(result.numBands[0] == kTestBands && result.numBands[1] == kTestBands);
+        float worst = 0.0f;
+        for (size_t i = 0; i < kTestBands; ++i)
+            worst = std::max({ worst, std::abs(result.meanDiffDb[0][i]), result.rmsDiffDb[0][i] });
+        CHECK(worst < 0.01f);
+
+        // The other way round B has to skip its start
+        CHECK(SessionDiff::compute(fileB, fileA, SessionDiff::Alignment::EnergyCorrelation, result));
+        CHECK(result.offsetFrames == -kOffset);
+
+        // Time alignment compares frame for frame and sees the shift as change
+        CHECK(SessionDiff::compute(fileA, fileB, SessionDiff::Alignment::Time, result));
+        CHECK(result.offsetFrames == 0);
+        CHECK(result.rmsDiffDb[0][0] > 1.0f);
+    }
+
+    void checkDiffFloor(const juce::File& dir)
+    {
+        // Slot 0: silence vs. noise, both under the compare floor. Slot 1: B moves
+        // 6 dB up and down around A, which cancels in the mean but not the RMS.
+        auto fileA = dir.getChildFile("floorA" + CaptureFormat::getFileExtension());
+        auto fileB = dir.getChildFile("floorB" + CaptureFormat::getFileExtension());
+        writeCapture(fileA, 20, [](int, size_t track) { return track == 0 ? -120.0f : -30.0f; });
+        writeCapture(fileB, 20, [](int frame, size_t track) {
+            return track == 0 ? -100.0f : (frame % 2 == 0 ? -24.0f : -36.0f);
+        });
+
+        SessionDiffResult result;
+        CHECK(SessionDiff::compute(fileA, fileB, SessionDiff::Alignment::Time, result));
+        CHECK(std::abs(result.meanDiffDb[0][0]) < 0.01f && result.rmsDiffDb[0][0] < 0.01f);
+        CHECK(std::abs(result.meanDiffDb[1][0]) < 0.01f);
+        CHECK(std::abs(result.rmsDiffDb[1][0] - 6.0f) < 0.01f);
+    }
+}
+
+int main()
+{
+    auto dir = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                   .getNonexistentChildFile("SpectralImager3D Checks", "");
+    if (!dir.createDirectory())
+    {
+        std::printf("Can't create %s\n", dir.getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    checkHitBoundaries(dir);
+    checkMerging(dir);
+    checkIndexValidation(dir);
+    checkCorruptFrames(dir);
+    checkAlignment(dir);
+    checkDiffFloor(dir);
+
+    dir.deleteRecursively();
+    std::printf("%d of %d checks passed\n", checks - failures, checks);
+    return failures == 0 ? 0 : 1;
+}
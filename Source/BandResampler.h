@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+    BandResampler.h - Maps a sender's band layout onto a common display grid
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedDataManager.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Every sender splits 20Hz-20kHz into N log-spaced bands, so a layout is fully
+// described by its band count. Resampling between two layouts is a fixed sparse
+// matrix of log-frequency overlaps; these are built once per (source, target)
+// pair and cached, leaving a small mat-vec per track per frame.
+class BandResampler
+{
+public:
+    // Resample srcBands levels into dstBands levels. Levels are RMS amplitudes,
+    // so the weighted average is taken in the power domain.
+    void process(int srcBands, int dstBands, const float* src, float* dst)
+    {
+        srcBands = juce::jlimit(1, static_cast<int>(kMaxBands), srcBands);
+        dstBands = juce::jlimit(1, static_cast<int>(kMaxBands), dstBands);
+
+        if (srcBands == dstBands)
+        {
+            std::copy(src, src + srcBands, dst);
+            return;
+        }
+
+        const auto& m = getMatrix(srcBands, dstBands);
+        for (size_t row = 0; row < static_cast<size_t>(dstBands); ++row)
+        {
+            float power = 0.0f;
+            for (size_t k = m.rowStart[row]; k < m.rowStart[row + 1]; ++k)
+            {
+                float s = src[m.cols[k]];
+                power += m.weights[k] * s * s;
+            }
+            dst[row] = std::sqrt(power);
+        }
+    }
+
+    // Resample a per-band quantity that averages linearly (e.g. pan histogram shares).
+    // Values are read and written every `stride` floats, so one bucket of an
+    // interleaved [band][bucket] table can be resampled in place of a plain array.
+    void processMean(int srcBands, int dstBands, const float* src, float* dst, size_t stride = 1)
+    {
+        srcBands = juce::jlimit(1, static_cast<int>(kMaxBands), srcBands);
+        dstBands = juce::jlimit(1, static_cast<int>(kMaxBands), dstBands);
+
+        if (srcBands == dstBands)
+        {
+            for (size_t i = 0; i < static_cast<size_t>(srcBands); ++i)
+                dst[i * stride] = src[i * stride];
+            return;
+        }
+
+        const auto& m = getMatrix(srcBands, dstBands);
+        for (size_t row = 0; row < static_cast<size_t>(dstBands); ++row)
+        {
+            float sum = 0.0f;
+            for (size_t k = m.rowStart[row]; k < m.rowStart[row + 1]; ++k)
+                sum += m.weights[k] * src[m.cols[k] * stride];
+            dst[row * stride] = sum;
+        }
+    }
+
+private:
+    // Compressed sparse rows: row r uses entries [rowStart[r], rowStart[r + 1])
+    struct Matrix
+    {
+        std::vector<size_t> rowStart;
+        std::vector<size_t> cols;
+        std::vector<float> weights;
+    };
+
+    const Matrix& getMatrix(int srcBands, int dstBands)
+    {
+        auto key = std::make_pair(srcBands, dstBands);
+        auto it = cache.find(key);
+        if (it != cache.end()) return it->second;
+
+        return cache.emplace(key, buildMatrix(srcBands, dstBands)).first->second;
+    }
+
+    static Matrix buildMatrix(int srcBands, int dstBands)
+    {
+        // Work in normalized log-frequency, where band i of N spans [i/N, (i+1)/N]
+        Matrix m;
+        m.rowStart.reserve(static_cast<size_t>(dstBands) + 1);
+        m.rowStart.push_back(0);
+
+        const float srcW = 1.0f / static_cast<float>(srcBands);
+        const float dstW = 1.0f / static_cast<float>(dstBands);
+
+        for (int row = 0; row < dstBands; ++row)
+        {
+            float lo = static_cast<float>(row) * dstW;
+            float hi = lo + dstW;
+
+            int first = std::max(0, static_cast<int>(std::floor(lo / srcW)));
+            int last = std::min(srcBands - 1, static_cast<int>(std::ceil(hi / srcW)));
+
+            size_t rowBegin = m.weights.size();
+            float total = 0.0f;
+            for (int col = first; col <= last; ++col)
+            {
+                float cLo = static_cast<float>(col) * srcW;
+                float overlap = std::min(hi, cLo + srcW) - std::max(lo, cLo);
+                if (overlap <= 1.0e-6f) continue;
+
+                m.cols.push_back(static_cast<size_t>(col));
+                m.weights.push_back(overlap);
+                total += overlap;
+            }
+
+            // Normalize so each row is a weighted mean
+            if (total > 0.0f)
+                for (size_t k = rowBegin; k < m.weights.size(); ++k)
+                    m.weights[k] /= total;
+
+            m.rowStart.push_back(m.weights.size());
+        }
+        return m;
+    }
+
+    std::map<std::pair<int, int>, Matrix> cache;
+};
@@ -0,0 +1,162 @@
+/*
+  ==============================================================================
+    CaptureFormat.h - On-disk frame format for captured sessions
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedDataManager.h"
+#include <array>
+#include <memory>
+
+// One snapshot of every slot. Levels are stored as 0.5 dB steps below 0 dBFS
+// (0 = 0 dB, 255 = -127.5 dB) so a frame is a fixed 2 KB and an hour at 10 Hz
+// stays around 75 MB on disk.
+struct CaptureFrame
+{
+    static constexpr float kFloorDb = -127.5f;
+
+    uint32_t timeMs = 0;
+    std::array<uint8_t, kMaxTracks> numBands{};  // 0 = slot inactive
+    std::array<std::array<uint8_t, kMaxBands>, kMaxTracks> left{}, right{};
+
+    static uint8_t quantize(float linearLevel)
+    {
+        float db = juce::Decibels::gainToDecibels(linearLevel, kFloorDb);
+        return static_cast<uint8_t>(juce::jlimit(0, 255, juce::roundToInt(-db * 2.0f)));
+    }
+
+    static float toDb(uint8_t q) { return static_cast<float>(q) * -0.5f; }
+
+    static float toPower(uint8_t q)
+    {
+        static const auto table = [] {
+            std::array<float, 256> t{};
+            for (size_t i = 0; i < t.size(); ++i)
+                t[i] = i == 255 ? 0.0f : std::pow(10.0f, toDb(static_cast<uint8_t>(i)) / 10.0f);
+            return t;
+        }();
+        return table[q];
+    }
+
+    bool isActive(size_t track) const { return numBands[track] > 0; }
+
+    void setTrack(size_t track, int bands, const float* leftLevels, const float* rightLevels)
+    {
+        bands = juce::jlimit(0, static_cast<int>(kMaxBands), bands);
+        numBands[track] = static_cast<uint8_t>(bands);
+        for (size_t b = 0; b < static_cast<size_t>(bands); ++b)
+        {
+            left[track][b] = quantize(leftLevels[b]);
+            right[track][b] = quantize(rightLevels[b]);
+        }
+    }
+
+    void captureFrom(const ITrackDataProvider& data, uint32_t time)
+    {
+        timeMs = time;
+        for (size_t t = 0; t < kMaxTracks; ++t)
+        {
+            const auto& track = data.getTrack(static_cast<int>(t));
+            numBands[t] = 0;
+            if (!track.isActive.load(std::memory_order_acquire)) continue;
+
+            std::array<float, kMaxBands> l{}, r{};
+            int bands = juce::jlimit(1, static_cast<int>(kMaxBands), track.numBands.load(std::memory_order_relaxed));
+            for (size_t b = 0; b < static_cast<size_t>(bands); ++b)
+                track.getBand(b, l[b], r[b]);
+            setTrack(t, bands, l.data(), r.data());
+        }
+    }
+};
+
+// File layout: 16 byte header (magic, version, frame rate, frame size) followed by
+// fixed-size frames, so any frame can be reached with a single seek.
+struct CaptureFormat
+{
+    static constexpr int kMagic = 0x43334953;  // "SI3C"
+    static constexpr int kVersion = 1;
+    static constexpr int kFrameRateHz = 10;
+    static constexpr int kHeaderBytes = 16;
+    static constexpr int kFrameBytes = 4 + static_cast<int>(kMaxTracks)
+                                     + static_cast<int>(kMaxTracks * kMaxBands * 2);
+
+    static juce::String getFileExtension() { return ".si3dcap"; }
+
+    static juce::File getDefaultFolder()
+    {
+        return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                   .getChildFile("SpectralImager3D Captures");
+    }
+};
+
+class CaptureReader
+{
+public:
+    bool open(const juce::File& file)
+    {
+        stream = std::make_unique<juce::FileInputStream>(file);
+        if (!stream->openedOk()
+            || stream->readInt() != CaptureFormat::kMagic
+            || stream->readInt() != CaptureFormat::kVersion)
+        {
+            stream.reset();
+            return false;
+        }
+
+        frameRate = stream->readInt();
+        if (stream->readInt() != CaptureFormat::kFrameBytes || frameRate <= 0)
+        {
+            stream.reset();
+            return false;
+        }
+
+        numFrames = (stream->getTotalLength() - CaptureFormat::kHeaderBytes) / CaptureFormat::kFrameBytes;
+        return true;
+    }
+
+    bool isOpen() const { return stream != nullptr; }
+    int64_t getNumFrames() const { return numFrames; }
+    int getFrameRate() const { return frameRate; }
+
+    bool seek(int64_t frame)
+    {
+        if (stream == nullptr || frame < 0 || frame > numFrames) return false;
+        return stream->setPosition(CaptureFormat::kHeaderBytes + frame * CaptureFormat::kFrameBytes);
+    }
+
+    bool read(CaptureFrame& f)
+    {
+        if (stream == nullptr) return false;
+
+        std::array<uint8_t, static_cast<size_t>(CaptureFormat::kFrameBytes)> raw;
+        if (stream->read(raw.data(), CaptureFormat::kFrameBytes) != CaptureFormat::kFrameBytes)
+            return false;
+
+        auto* p = raw.data();
+        f.timeMs = juce::ByteOrder::littleEndianInt(p);
+        p += 4;
+        std::copy(p, p + kMaxTracks, f.numBands.begin());
+        p += kMaxTracks;
+
+        // Every reader indexes the band arrays by these counts; a corrupt or foreign
+        // file ends the stream here rather than sending them past kMaxBands
+        for (auto n : f.numBands)
+            if (n > kMaxBands) return false;
+        for (size_t t = 0; t < kMaxTracks; ++t)
+        {
+            std::copy(p, p + kMaxBands, f.left[t].begin());
+            p += kMaxBands;
+            std::copy(p, p + kMaxBands, f.right[t].begin());
+            p += kMaxBands;
+        }
+        return true;
+    }
+
+private:
+    std::unique_ptr<juce::FileInputStream> stream;
+    int64_t numFrames = 0;
+    int frameRate = CaptureFormat::kFrameRateHz;
+};
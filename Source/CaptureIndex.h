@@ -0,0 +1,276 @@
+/*
+  ==============================================================================
+    CaptureIndex.h - Per-block band summaries for querying captured sessions
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CaptureFormat.h"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+// "When did tracks A and B both sit above X dB between these frequencies?"
+struct ConflictQuery
+{
+    int trackA = 0, trackB = 1;  // Slots
+    float thresholdDb = -20.0f;
+    float minHz = 20.0f, maxHz = 120.0f;
+    int mergeGapFrames = CaptureFormat::kFrameRateHz;  // Runs at most this far apart form one hit, so a beat-by-beat overlap reads as one
+};
+
+// A run of consecutive frames that match a query
+struct ConflictHit
+{
+    int64_t startFrame = 0, endFrame = 0;  // Inclusive
+    uint32_t startMs = 0, endMs = 0;
+};
+
+// The index maps every slot onto a fixed 48-band grid and keeps, for each block of
+// frames, the loudest level each slot reached in each band. A query only has to
+// read the blocks whose summaries could match, then confirm them frame by frame.
+struct CaptureIndexFormat
+{
+    static constexpr int kMagic = 0x58334953;  // "SI3X"
+    static constexpr int kVersion = 2;
+    static constexpr size_t kIndexBands = 48;
+    static constexpr int kFramesPerBlock = CaptureFormat::kFrameRateHz;  // One second
+    static constexpr int kHeaderBytes = 24;  // Ends with the frame count, written on close
+    static constexpr int kFrameCountOffset = 16;
+    static constexpr size_t kBlockBytes = kMaxTracks * kIndexBands;
+
+    using Bands = std::array<uint8_t, kIndexBands>;
+    using Block = std::array<Bands, kMaxTracks>;
+
+    static juce::File fileFor(const juce::File& capture) { return capture.withFileExtension(".si3didx"); }
+
+    // Loudest quantized level (lowest code) of a slot per index band, 255 if inactive
+    static void toIndexBands(const CaptureFrame& f, size_t track, Bands& out)
+    {
+        out.fill(255);
+        const size_t bands = f.numBands[track];
+        for (size_t j = 0; j < bands; ++j)
+        {
+            // Index bands overlapping source band j, both grids being log-uniform over 20Hz-20kHz
+            size_t lo = j * kIndexBands / bands;
+            size_t hi = ((j + 1) * kIndexBands + bands - 1) / bands;
+            uint8_t q = std::min(f.left[track][j], f.right[track][j]);
+            for (size_t i = lo; i < hi; ++i)
+                out[i] = std::min(out[i], q);
+        }
+    }
+
+    static int64_t numBlocksFor(int64_t numFrames) { return (numFrames + kFramesPerBlock - 1) / kFramesPerBlock; }
+
+    static size_t bandForFrequency(float hz)
+    {
+        float t = std::log10(juce::jlimit(20.0f, 20000.0f, hz) / 20.0f) / 3.0f;
+        return std::min(kIndexBands - 1, static_cast<size_t>(t * static_cast<float>(kIndexBands)));
+    }
+};
+
+// Fed by CaptureWriter as frames are written
+class CaptureIndexBuilder
+{
+public:
+    bool open(const juce::File& indexFile)
+    {
+        close();
+        indexFile.deleteFile();
+        stream = std::make_unique<juce::FileOutputStream>(indexFile);
+        if (!stream->openedOk()) { stream.reset(); return false; }
+
+        stream->writeInt(CaptureIndexFormat::kMagic);
+        stream->writeInt(CaptureIndexFormat::kVersion);
+        stream->writeInt(CaptureIndexFormat::kFramesPerBlock);
+        stream->writeInt(static_cast<int>(CaptureIndexFormat::kIndexBands));
+        stream->writeInt64(0);  // Frame count, left at 0 until close() so an unfinished index never matches
+        numFrames = 0;
+        resetBlock();
+        return true;
+    }
+
+    void add(const CaptureFrame& f)
+    {
+        if (stream == nullptr) return;
+
+        CaptureIndexFormat::Bands bands;
+        for (size_t t = 0; t < kMaxTracks; ++t)
+        {
+            CaptureIndexFormat::toIndexBands(f, t, bands);
+            for (size_t i = 0; i < CaptureIndexFormat::kIndexBands; ++i)
+                block[t][i] = std::min(block[t][i], bands[i]);
+        }
+
+        ++numFrames;
+        if (++framesInBlock == CaptureIndexFormat::kFramesPerBlock)
+            writeBlock();
+    }
+
+    void close()
+    {
+        if (stream == nullptr) return;
+        if (framesInBlock > 0) writeBlock();
+        if (stream->setPosition(CaptureIndexFormat::kFrameCountOffset))
+            stream->writeInt64(numFrames);
+        stream->flush();
+        stream.reset();
+    }
+
+private:
+    void resetBlock()
+    {
+        for (auto& b : block) b.fill(255);
+        framesInBlock = 0;
+    }
+
+    void writeBlock()
+    {
+        for (const auto& b : block)
+            stream->write(b.data(), b.size());
+        resetBlock();
+    }
+
+    std::unique_ptr<juce::FileOutputStream> stream;
+    CaptureIndexFormat::Block block;
+    int framesInBlock = 0;
+    int64_t numFrames = 0;
+};
+
+class CaptureIndex
+{
+public:
+    // Loads the sidecar index of a capture, rebuilding it first if it is missing or
+    // doesn't cover the capture (unfinished recording, capture replaced, old format).
+    // A rebuild reads the whole capture, so call this off the message thread.
+    bool load(const juce::File& capture, const std::atomic<bool>* shouldExit = nullptr)
+    {
+        captureFile = capture;
+        blocks.clear();
+
+        CaptureReader reader;
+        if (!reader.open(capture)) return false;
+        const int64_t numFrames = reader.getNumFrames();
+
+        auto indexFile = CaptureIndexFormat::fileFor(capture);
+        if (readIndex(indexFile, numFrames)) return true;
+        return rebuild(capture, indexFile, shouldExit) && readIndex(indexFile, numFrames);
+    }
+
+    const juce::File& getCaptureFile() const { return captureFile; }
+
+    std::vector<ConflictHit> findOverlaps(const ConflictQuery& q, const std::atomic<bool>* shouldExit = nullptr) const
+    {
+        std::vector<ConflictHit> hits;
+        if (q.trackA < 0 || q.trackB < 0 || q.trackA == q.trackB
+            || q.trackA >= static_cast<int>(kMaxTracks) || q.trackB >= static_cast<int>(kMaxTracks))
+            return hits;
+
+        CaptureReader reader;
+        if (!reader.open(captureFile)) return hits;
+
+        const auto a = static_cast<size_t>(q.trackA), b = static_cast<size_t>(q.trackB);
+        const size_t lo = CaptureIndexFormat::bandForFrequency(std::min(q.minHz, q.maxHz));
+        const size_t hi = CaptureIndexFormat::bandForFrequency(std::max(q.minHz, q.maxHz));
+        const auto qThr = static_cast<uint8_t>(juce::jlimit(0, 254, static_cast<int>(std::floor(-2.0f * q.thresholdDb))));
+
+        auto overlaps = [&](const CaptureIndexFormat::Bands& bandsA, const CaptureIndexFormat::Bands& bandsB) {
+            for (size_t i = lo; i <= hi; ++i)
+                if (bandsA[i] <= qThr && bandsB[i] <= qThr) return true;
+            return false;
+        };
+
+        ConflictHit run;
+        bool inRun = false;
+        int64_t lastFrame = 0;
+        const int64_t maxStep = std::max(0, q.mergeGapFrames) + 1;
+        CaptureFrame frame;
+        CaptureIndexFormat::Bands bandsA, bandsB;
+
+        for (size_t blk = 0; blk < blocks.size(); ++blk)
+        {
+            if (shouldExit != nullptr && shouldExit->load()) break;
+            if (!overlaps(blocks[blk][a], blocks[blk][b])) continue;
+
+            // Candidate block: confirm frame by frame
+            auto first = static_cast<int64_t>(blk) * CaptureIndexFormat::kFramesPerBlock;
+            if (!reader.seek(first)) break;
+
+            for (int k = 0; k < CaptureIndexFormat::kFramesPerBlock && reader.read(frame); ++k)
+            {
+                int64_t index = first + k;
+                CaptureIndexFormat::toIndexBands(frame, a, bandsA);
+                CaptureIndexFormat::toIndexBands(frame, b, bandsB);
+                if (!overlaps(bandsA, bandsB)) continue;
+
+                if (inRun && index - lastFrame <= maxStep)
+                {
+                    run.endFrame = index;
+                    run.endMs = frame.timeMs;
+                }
+                else
+                {
+                    if (inRun) hits.push_back(run);
+                    run = { index, index, frame.timeMs, frame.timeMs };
+                    inRun = true;
+                }
+                lastFrame = index;
+            }
+        }
+        if (inRun) hits.push_back(run);
+        return hits;
+    }
+
+private:
+    bool readIndex(const juce::File& indexFile, int64_t numFrames)
+    {
+        blocks.clear();
+        juce::FileInputStream in(indexFile);
+        if (!in.openedOk()
+            || in.readInt() != CaptureIndexFormat::kMagic
+            || in.readInt() != CaptureIndexFormat::kVersion
+            || in.readInt() != CaptureIndexFormat::kFramesPerBlock
+            || in.readInt() != static_cast<int>(CaptureIndexFormat::kIndexBands)
+            || in.readInt64() != numFrames)
+            return false;
+
+        const int64_t numBlocks = CaptureIndexFormat::numBlocksFor(numFrames);
+        if (in.getNumBytesRemaining() != numBlocks * static_cast<int64_t>(CaptureIndexFormat::kBlockBytes))
+            return false;
+
+        blocks.resize(static_cast<size_t>(numBlocks));
+        for (auto& b : blocks)
+            for (auto& bands : b)
+                in.read(bands.data(), static_cast<int>(bands.size()));
+        return true;
+    }
+
+    static bool rebuild(const juce::File& capture, const juce::File& indexFile, const std::atomic<bool>* shouldExit)
+    {
+        CaptureReader reader;
+        CaptureIndexBuilder builder;
+        if (!reader.open(capture) || !builder.open(indexFile)) return false;
+
+        CaptureFrame frame;
+        while (reader.read(frame))
+        {
+            if (shouldExit != nullptr && shouldExit->load())
+            {
+                // A partial index would be taken as complete next time
+                builder.close();
+                indexFile.deleteFile();
+                return false;
+            }
+            builder.add(frame);
+        }
+        builder.close();
+        return true;
+    }
+
+    juce::File captureFile;
+    std::vector<CaptureIndexFormat::Block> blocks;
+};
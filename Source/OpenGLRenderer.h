@@ -8,6 +8,11 @@
 
 #include <JuceHeader.h>
 #include "SharedDataManager.h"
+#include "BandResampler.h"
+#include "TrackClusterer.h"
+#include "SessionDiff.h"
+#include "CaptureFormat.h"
+#include "PeakCollisions.h"
 #include <vector>
 #include <array>
 #include <cmath>
@@ -26,6 +31,9 @@ enum class ViewMode { Perspective3D, TopFlat, SideFlat };
 
 struct Vtx { float x, y, z, r, g, b, a; };
 
+// One line segment, drawn as an instance that the line shader expands into a quad
+struct LineSeg { float x1, y1, z1, x2, y2, z2, r, g, b, a; };
+
 // Store history of stereo positions for tracer effect
 struct BandHistory
 {
@@ -71,6 +79,9 @@ public:
         ctx.setComponentPaintingEnabled(true);
         ctx.attachTo(*this);
         
+        for (auto& c : trackClusters)
+            c.store(-1);
+        
         // Initialize history for all possible tracks and bands
         for (auto& trackHist : bandHistories)
             for (auto& hist : trackHist)
@@ -88,6 +99,48 @@ public:
     
     void setViewMode(ViewMode m) { viewMode = m; repaint(); }
     ViewMode getViewMode() const { return viewMode; }
+    
+    // Draw similar tracks as aggregated cluster bars instead of one bar set per track
+    void setClustering(bool shouldGroup)
+    {
+        clustering.store(shouldGroup, std::memory_order_relaxed);
+        expandedClusters.store(0, std::memory_order_relaxed);
+    }
+    bool isClustering() const { return clustering.load(std::memory_order_relaxed); }
+    
+    // Replace the live view with a capture diff, coloured by B - A per band; nullptr returns to live
+    void setDiffOverlay(std::shared_ptr<const SessionDiffResult> diff)
+    {
+        std::atomic_store(&diffOverlay, std::move(diff));
+        repaint();
+    }
+    bool hasDiffOverlay() const { return std::atomic_load(&diffOverlay) != nullptr; }
+    
+    // Show one captured frame instead of live data (e.g. a query hit); nullptr returns to live
+    void setReplayFrame(std::shared_ptr<const CaptureFrame> frame, const juce::String& label = {})
+    {
+        std::atomic_store(&replayFrame, std::move(frame));
+        replayLabel = label;
+        repaint();
+    }
+    bool isReplaying() const { return std::atomic_load(&replayFrame) != nullptr; }
+    
+    // Expand or collapse the cluster currently holding this track
+    void toggleClusterOfTrack(int track) { toggleCluster(getClusterOfTrack(track)); }
+    
+    void toggleCluster(int c)
+    {
+        if (c < 0 || c >= static_cast<int>(TrackClusterer::kMaxClusters)) return;
+        expandedClusters.fetch_xor(1u << static_cast<uint32_t>(c), std::memory_order_relaxed);
+        repaint();
+    }
+    
+    // Cluster currently holding a track, -1 if ungrouped or inactive
+    int getClusterOfTrack(int track) const
+    {
+        if (!isClustering() || track < 0 || track >= static_cast<int>(kMaxTracks)) return -1;
+        return trackClusters[static_cast<size_t>(track)].load(std::memory_order_relaxed);
+    }
 
     void resetView() { 
         rotX = defaultRotX; 
@@ -134,8 +187,8 @@ public:
             
             buildGeometry();
             
-            if (!lineVerts.empty() || !triVerts.empty())
-                drawVerts();
+            if (!lineSegs.empty() || !triVerts.empty())
+                drawVerts(proj, view, scale);
         }
         
         glDisable(GL_BLEND);
@@ -145,7 +198,9 @@ public:
     void openGLContextClosing() override
     {
         shader.reset();
+        lineShader.reset();
         if (lineVbo != 0) { juce::gl::glDeleteBuffers(1, &lineVbo); lineVbo = 0; }
+        if (cornerVbo != 0) { juce::gl::glDeleteBuffers(1, &cornerVbo); cornerVbo = 0; }
         if (triVbo != 0) { juce::gl::glDeleteBuffers(1, &triVbo); triVbo = 0; }
     }
     
@@ -155,38 +210,7 @@ public:
         g.setColour(juce::Colour(Colors::text));
         g.setFont(12.0f);
         
-        auto project = [this](float x, float y, float z) -> juce::Point<float> {
-            auto proj = makeProj(static_cast<float>(getWidth()), static_cast<float>(getHeight()));
-            auto view = makeView();
-            
-            // Model (Identity) -> View -> Proj
-            // Manual matrix multiplication: v' = P * V * v
-            float v[4] = {x, y, z, 1.0f};
-            float eye[4] = {0,0,0,0};
-            
-            // View transform
-            for(int r=0; r<4; ++r) 
-                for(int c=0; c<4; ++c) 
-                    eye[r] += view[static_cast<size_t>(c*4 + r)] * v[c];
-            
-            // Proj transform
-            float clip[4] = {0,0,0,0};
-            for(int r=0; r<4; ++r) 
-                for(int c=0; c<4; ++c) 
-                    clip[r] += proj[static_cast<size_t>(c*4 + r)] * eye[c];
-            
-            if (clip[3] == 0.0f) return { -1000.0f, -1000.0f };
-            
-            // NDC
-            float ndcX = clip[0] / clip[3];
-            float ndcY = clip[1] / clip[3];
-            
-            // Screen
-            return {
-                (ndcX + 1.0f) * 0.5f * static_cast<float>(getWidth()),
-                (1.0f - ndcY) * 0.5f * static_cast<float>(getHeight()) // Flip Y for JUCE
-            };
-        };
+        auto project = [this](float x, float y, float z) { return projectToScreen(x, y, z); };
         
         auto drawLabel = [&](const juce::String& text, float x, float y, float z, 
                              juce::Justification just = juce::Justification::centred) {
@@ -199,6 +223,23 @@ public:
             return -1.0f + 2.0f * (std::log10(f) - std::log10(20.0f)) / (std::log10(20000.0f) - std::log10(20.0f));
         };
 
+        if (isReplaying() && !hasDiffOverlay())
+        {
+            g.drawText("Replay " + replayLabel, 8, 4, getWidth() - 16, 18, juce::Justification::left);
+        }
+        else if (hasDiffOverlay())
+        {
+            juce::String text = "Diff B - A (blue quieter, red louder, yellow both ways; full at "
+                              + juce::String(static_cast<int>(kDiffColourRangeDb)) + " dB RMS)";
+            if (auto diff = std::atomic_load(&diffOverlay); diff != nullptr && diff->offsetFrames != 0)
+            {
+                float seconds = static_cast<float>(std::abs(diff->offsetFrames)) / CaptureFormat::kFrameRateHz;
+                text << (diff->offsetFrames > 0 ? ", B aligned to A + " : ", A aligned to B + ")
+                     << juce::String(seconds, 1) << " s";
+            }
+            g.drawText(text, 8, 4, getWidth() - 16, 18, juce::Justification::left);
+        }
+        
         if (viewMode == ViewMode::Perspective3D)
         {
             drawLabel("L", -1.2f, -1.0f, -1.2f);
@@ -263,10 +304,18 @@ public:
                  drawLabel(juce::String(static_cast<int>(db)), -1.0f, y, 1.15f, juce::Justification::left);
              }
         }
+        
+        paintClusterLabels(g);
     }
     
     void mouseDown(const juce::MouseEvent& e) override { lastMouse = e.position; }
     
+    // A click (no drag) on a group's label or aggregated bars expands or collapses it
+    void mouseUp(const juce::MouseEvent& e) override
+    {
+        if (e.mouseWasClicked()) toggleCluster(findClusterAt(e.position));
+    }
+    
     void mouseDrag(const juce::MouseEvent& e) override
     {
         if (viewMode != ViewMode::Perspective3D) return;
@@ -285,6 +334,96 @@ public:
     }
     
 private:
+    // Model space to component pixels, offscreen for points behind the camera
+    juce::Point<float> projectToScreen(float x, float y, float z)
+    {
+        auto proj = makeProj(static_cast<float>(getWidth()), static_cast<float>(getHeight()));
+        auto view = makeView();
+        
+        // Model (Identity) -> View -> Proj
+        // Manual matrix multiplication: v' = P * V * v
+        float v[4] = {x, y, z, 1.0f};
+        float eye[4] = {0,0,0,0};
+        
+        // View transform
+        for(int r=0; r<4; ++r) 
+            for(int c=0; c<4; ++c) 
+                eye[r] += view[static_cast<size_t>(c*4 + r)] * v[c];
+        
+        // Proj transform
+        float clip[4] = {0,0,0,0};
+        for(int r=0; r<4; ++r) 
+            for(int c=0; c<4; ++c) 
+                clip[r] += proj[static_cast<size_t>(c*4 + r)] * eye[c];
+        
+        if (clip[3] <= 0.0f) return { -1000.0f, -1000.0f };
+        
+        // NDC
+        float ndcX = clip[0] / clip[3];
+        float ndcY = clip[1] / clip[3];
+        
+        // Screen
+        return {
+            (ndcX + 1.0f) * 0.5f * static_cast<float>(getWidth()),
+            (1.0f - ndcY) * 0.5f * static_cast<float>(getHeight()) // Flip Y for JUCE
+        };
+    }
+    
+    bool showsClusterLabels() const { return isClustering() && !hasDiffOverlay(); }
+    
+    // Group label at each cluster's anchor: number, member count and state
+    void paintClusterLabels(juce::Graphics& g)
+    {
+        if (!showsClusterLabels()) return;
+        
+        uint32_t expanded = expandedClusters.load(std::memory_order_relaxed);
+        for (size_t c = 0; c < TrackClusterer::kMaxClusters; ++c)
+        {
+            const auto& a = clusterAnchors[c];
+            int members = a.members.load(std::memory_order_relaxed);
+            if (members == 0) continue;
+            
+            auto pt = projectToScreen(a.x.load(std::memory_order_relaxed), a.y.load(std::memory_order_relaxed),
+                                      a.z.load(std::memory_order_relaxed));
+            juce::String text = "G" + juce::String(static_cast<int>(c) + 1) + " x" + juce::String(members)
+                              + (((expanded >> c) & 1u) ? " -" : " +");
+            auto box = juce::Rectangle<float>(60.0f, 16.0f).withCentre(pt.translated(0.0f, -12.0f));
+            
+            g.setColour(juce::Colour(Colors::bg1).withAlpha(0.7f));
+            g.fillRoundedRectangle(box, 3.0f);
+            g.setColour(juce::Colour(a.colour.load(std::memory_order_relaxed)));
+            g.drawText(text, box, juce::Justification::centred);
+        }
+    }
+    
+    // Cluster whose label or anchor lies nearest to a click, -1 if none is close
+    int findClusterAt(juce::Point<float> pos)
+    {
+        if (!showsClusterLabels()) return -1;
+        
+        int best = -1;
+        float bestDist = kClusterPickRadius;
+        for (size_t c = 0; c < TrackClusterer::kMaxClusters; ++c)
+        {
+            const auto& a = clusterAnchors[c];
+            if (a.members.load(std::memory_order_relaxed) == 0) continue;
+            
+            auto pt = projectToScreen(a.x.load(std::memory_order_relaxed), a.y.load(std::memory_order_relaxed),
+                                      a.z.load(std::memory_order_relaxed));
+            float dist = std::min(pos.getDistanceFrom(pt), pos.getDistanceFrom(pt.translated(0.0f, -12.0f)));
+            if (dist < bestDist) { bestDist = dist; best = static_cast<int>(c); }
+        }
+        return best;
+    }
+    
+    // Per-track levels and pan shares on the display grid, rebuilt every frame
+    struct TrackFrame
+    {
+        std::array<float, kMaxBands> left{}, right{};
+        std::array<float, kMaxBands * kPanBuckets> pan{};
+        juce::Colour colour;
+    };
+    
     void timerCallback() override
     {
         // Increased timeout to 4000ms to prevent flickering when playback pauses
@@ -320,6 +459,78 @@ private:
             aPos = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*shader, "aPos");
             aCol = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*shader, "aCol");
         }
+        
+        buildLineShader();
+    }
+    
+    // Thick lines: each segment is one instance, expanded into a screen-aligned quad
+    // in the vertex shader. vEdge carries the pixel distance from the centre line so
+    // the fragment shader can antialias the edges analytically. This replaces
+    // glLineWidth, which core profiles and several drivers ignore.
+    void buildLineShader()
+    {
+        const char* vs = R"(
+            attribute vec2 aCorner;
+            attribute vec3 aStart;
+            attribute vec3 aEnd;
+            attribute vec4 aCol;
+            uniform mat4 uProj, uView;
+            uniform vec2 uViewport;
+            uniform float uWidth;
+            varying vec4 vCol;
+            varying float vEdge;
+            void main() {
+                vec4 c0 = uProj * uView * vec4(aStart, 1.0);
+                vec4 c1 = uProj * uView * vec4(aEnd, 1.0);
+                // Clip to the near plane (z = -w) before dividing, as the hardware
+                // does for GL_LINES; an endpoint behind the eye would flip dir
+                float d0 = c0.z + c0.w;
+                float d1 = c1.z + c1.w;
+                if (d0 < 0.0 && d1 < 0.0) {
+                    vCol = vec4(0.0);
+                    vEdge = 0.0;
+                    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+                    return;
+                }
+                if (d0 < 0.0) c0 = mix(c0, c1, d0 / (d0 - d1));
+                else if (d1 < 0.0) c1 = mix(c1, c0, d1 / (d1 - d0));
+                vec2 halfVp = uViewport * 0.5;
+                vec2 dir = c1.xy / c1.w * halfVp - c0.xy / c0.w * halfVp;
+                float len = length(dir);
+                dir = len > 0.0001 ? dir / len : vec2(1.0, 0.0);
+                float extent = uWidth * 0.5 + 1.0;
+                vec4 pos = mix(c0, c1, aCorner.x);
+                pos.xy += vec2(-dir.y, dir.x) * aCorner.y * extent / halfVp * pos.w;
+                vCol = aCol;
+                vEdge = aCorner.y * extent;
+                gl_Position = pos;
+            })";
+        
+        const char* fs = R"(
+            uniform float uWidth;
+            varying vec4 vCol;
+            varying float vEdge;
+            void main() {
+                float coverage = clamp(uWidth * 0.5 + 0.5 - abs(vEdge), 0.0, 1.0);
+                if (coverage <= 0.0) discard;
+                gl_FragColor = vec4(vCol.rgb, vCol.a * coverage);
+            })";
+        
+        auto s = std::make_unique<juce::OpenGLShaderProgram>(ctx);
+        if (s->addVertexShader(juce::OpenGLHelpers::translateVertexShaderToV3(vs))
+            && s->addFragmentShader(juce::OpenGLHelpers::translateFragmentShaderToV3(fs))
+            && s->link())
+        {
+            lineShader = std::move(s);
+            lProj = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*lineShader, "uProj");
+            lView = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*lineShader, "uView");
+            lViewport = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*lineShader, "uViewport");
+            lWidth = std::make_unique<juce::OpenGLShaderProgram::Uniform>(*lineShader, "uWidth");
+            lCorner = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*lineShader, "aCorner");
+            lStart = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*lineShader, "aStart");
+            lEnd = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*lineShader, "aEnd");
+            lCol = std::make_unique<juce::OpenGLShaderProgram::Attribute>(*lineShader, "aCol");
+        }
     }
     
     std::array<float, 16> makeProj(float w, float h)
@@ -395,9 +606,9 @@ private:
     
     void buildGeometry()
     {
-        lineVerts.clear();
+        lineSegs.clear();
         triVerts.clear();
-        lineVerts.reserve(3000);
+        lineSegs.reserve(1500);
         triVerts.reserve(10000);
         
         addGrid();
@@ -407,8 +618,7 @@ private:
     void addLine(float x1, float y1, float z1, float x2, float y2, float z2,
                  float r, float g, float b, float a)
     {
-        lineVerts.push_back({x1, y1, z1, r, g, b, a});
-        lineVerts.push_back({x2, y2, z2, r, g, b, a});
+        lineSegs.push_back({x1, y1, z1, x2, y2, z2, r, g, b, a});
     }
     
     void addTriangle(float x1, float y1, float z1,
@@ -470,150 +680,449 @@ private:
         addLine(0, -1, -1, 0, -1, 1, ac.getFloatRed(), ac.getFloatGreen(), ac.getFloatBlue(), 0.5f);
     }
     
+    static float levelToY(float linearLevel, float rangeVal)
+    {
+        if (linearLevel < 0.0001f) return -1.0f;
+        float db = juce::Decibels::gainToDecibels(linearLevel, -100.0f);
+        float normalized = (db + rangeVal) / rangeVal;
+        return juce::jlimit(-1.0f, 1.0f, normalized * 2.0f - 1.0f);
+    }
+    
     void addTracks()
     {
         float rangeVal = rangePtr != nullptr ? rangePtr->load() : 36.0f;
         
-        auto levelToY = [rangeVal](float linearLevel) {
-            if (linearLevel < 0.0001f) return -1.0f;
-            float db = juce::Decibels::gainToDecibels(linearLevel, -100.0f);
-            float normalized = (db + rangeVal) / rangeVal;
-            return juce::jlimit(-1.0f, 1.0f, normalized * 2.0f - 1.0f);
+        if (auto diff = std::atomic_load(&diffOverlay))
+        {
+            addDiffTracks(*diff, rangeVal);
+            return;
+        }
+        
+        // While replaying, levels come from the captured frame and colours from the live slots
+        auto replay = std::atomic_load(&replayFrame);
+        
+        auto bandsOf = [&replay](size_t t, const TrackData& track) {
+            if (replay != nullptr) return static_cast<int>(replay->numBands[t]);
+            int n = track.numBands.load(std::memory_order_relaxed);
+            return n < 1 ? 24 : std::min(n, static_cast<int>(kMaxBands));
         };
         
+        // Common display grid: the finest layout among active senders, so every
+        // track's bands line up in frequency without losing resolution
+        int numBands = 0;
+        for (size_t t = 0; t < kMaxTracks; ++t)
+        {
+            const auto& track = sharedData.getTrack(static_cast<int>(t));
+            active[t] = replay != nullptr ? replay->isActive(t) : track.isActive.load(std::memory_order_acquire);
+            if (active[t])
+                numBands = std::max(numBands, bandsOf(t, track));
+        }
+        
+        std::array<float, kMaxBands> srcLeft{}, srcRight{};
+        std::array<float, kMaxBands * kPanBuckets> srcPan{};
+        // Pan axis isn't visible from the side, and captures don't store pan histograms
+        const bool showSpread = viewMode != ViewMode::SideFlat && replay == nullptr;
+        const bool grouped = clustering.load(std::memory_order_relaxed);
+        
         for (size_t t = 0; t < kMaxTracks; ++t)
         {
+            if (!active[t]) continue;
             const auto& track = sharedData.getTrack(static_cast<int>(t));
-            if (!track.isActive.load(std::memory_order_acquire)) continue;
+            auto& frame = frames[t];
             
-            auto col = track.getColor();
-            float cr = std::min(1.0f, col.getFloatRed() * 1.3f);
-            float cg = std::min(1.0f, col.getFloatGreen() * 1.3f);
-            float cb = std::min(1.0f, col.getFloatBlue() * 1.3f);
+            int trackBands = bandsOf(t, track);
+            if (replay != nullptr)
+            {
+                frame.colour = track.isActive.load(std::memory_order_relaxed)
+                    ? track.getColor()
+                    : juce::Colour::fromHSV(static_cast<float>(t) / static_cast<float>(kMaxTracks), 0.8f, 1.0f, 1.0f);
+                for (size_t band = 0; band < static_cast<size_t>(trackBands); ++band)
+                {
+                    srcLeft[band] = juce::Decibels::decibelsToGain(CaptureFrame::toDb(replay->left[t][band]), CaptureFrame::kFloorDb);
+                    srcRight[band] = juce::Decibels::decibelsToGain(CaptureFrame::toDb(replay->right[t][band]), CaptureFrame::kFloorDb);
+                }
+                std::fill(frame.pan.begin(), frame.pan.end(), 0.0f);
+            }
+            else
+            {
+                frame.colour = track.getColor();
+                for (int band = 0; band < trackBands; ++band)
+                    track.getBand(static_cast<size_t>(band), srcLeft[static_cast<size_t>(band)],
+                                  srcRight[static_cast<size_t>(band)]);
+            }
             
-            int numBands = track.numBands.load(std::memory_order_relaxed);
-            if (numBands < 1) numBands = 24;
+            resampler.process(trackBands, numBands, srcLeft.data(), frame.left.data());
+            resampler.process(trackBands, numBands, srcRight.data(), frame.right.data());
             
-            // Fixed width for all bands
-            constexpr float bandWidth = 0.03f;
+            if (replay == nullptr && (showSpread || grouped))
+            {
+                for (int band = 0; band < trackBands; ++band)
+                    track.getPanHistogram(static_cast<size_t>(band), srcPan.data() + static_cast<size_t>(band) * kPanBuckets);
+                for (size_t k = 0; k < kPanBuckets; ++k)
+                    resampler.processMean(trackBands, numBands, srcPan.data() + k, frame.pan.data() + k, kPanBuckets);
+            }
+        }
+        
+        // Captures only hold band levels, so tonal peaks are a live-only layer
+        if (replay == nullptr)
+            addTonalPeaks(rangeVal);
+        
+        if (!grouped)
+        {
+            for (size_t t = 0; t < kMaxTracks; ++t)
+                if (active[t])
+                    addTrackBars(frames[t], numBands, rangeVal, showSpread, bandHistories[t]);
+            return;
+        }
+        
+        // Grouped: cluster by band profile and pan, then draw one aggregated bar set
+        // per cluster unless it has been expanded
+        for (size_t t = 0; t < kMaxTracks; ++t)
+        {
+            if (!active[t]) continue;
+            auto& f = features[t];
+            const auto& frame = frames[t];
+            for (size_t b = 0; b < static_cast<size_t>(numBands); ++b)
+            {
+                float level = (levelToY(std::max(frame.left[b], frame.right[b]), rangeVal) + 1.0f) * 0.5f;
+                float balance = (frame.right[b] - frame.left[b]) / (frame.left[b] + frame.right[b] + 0.0001f);
+                f[b * 2] = level;
+                f[b * 2 + 1] = balance * level;
+            }
+        }
+        clusterer.update(features, active, numBands * 2);
+        for (size_t t = 0; t < kMaxTracks; ++t)
+            trackClusters[t].store(clusterer.getCluster(t), std::memory_order_relaxed);
+        
+        // A freed or reseeded slot holds a different group; it starts collapsed
+        for (size_t c = 0; c < TrackClusterer::kMaxClusters; ++c)
+        {
+            uint32_t generation = clusterer.getGeneration(c);
+            if (generation == clusterGenerations[c]) continue;
+            clusterGenerations[c] = generation;
+            expandedClusters.fetch_and(~(1u << static_cast<uint32_t>(c)), std::memory_order_relaxed);
+        }
+        
+        uint32_t expanded = expandedClusters.load(std::memory_order_relaxed);
+        for (size_t c = 0; c < TrackClusterer::kMaxClusters; ++c)
+        {
+            auto& agg = clusterFrames[c];
+            agg = TrackFrame{};
+            float red = 0.0f, green = 0.0f, blue = 0.0f;
+            int members = 0;
+            const bool isExpanded = ((expanded >> c) & 1u) != 0;
             
-            for (int band = 0; band < numBands; ++band)
+            for (size_t t = 0; t < kMaxTracks; ++t)
             {
-                float left, right;
-                track.getBand(static_cast<size_t>(band), left, right);
-                
-                float z = -1.0f + (static_cast<float>(band) + 0.5f) / static_cast<float>(numBands) * 2.0f;
-                float ly = levelToY(left);
-                float ry = levelToY(right);
-                float avgY = (ly + ry) * 0.5f;
-                
-                if (avgY < -0.95f) continue;
-                
-                // Pan position: -1 = full left, +1 = full right
-                float total = left + right + 0.0001f;
-                float balance = (right - left) / total;
-                float centerX = balance;  // Full range -1 to +1
-                
-                // Update history for this band
-                auto& hist = bandHistories[t][static_cast<size_t>(band)];
-                hist.push(centerX);
-                
-                float alpha = juce::jlimit(0.5f, 1.0f, avgY * 0.5f + 0.7f);
-                
-                // New Opacity Logic: 
-                // 0 to -60dB -> Full opacity based on alpha calc above
-                // -60 to -90dB -> Fade to 0
-                // We need to recover dB from avgY? No, use the raw level.
-                // Re-calculate dB for opacity check using max of L/R
-                float maxLevel = std::max(left, right);
-                float db = juce::Decibels::gainToDecibels(maxLevel, -120.0f);
-                
-                if (db < -50.0f)
-                {
-                    float fade = juce::jmap(db, -90.0f, -50.0f, 0.0f, 1.0f);
-                    alpha *= std::max(0.0f, fade);
-                }
+                if (!active[t] || clusterer.getCluster(t) != static_cast<int>(c)) continue;
                 
-                if (alpha < 0.01f) continue;
+                const auto& frame = frames[t];
+                if (isExpanded)
+                    addTrackBars(frame, numBands, rangeVal, showSpread, bandHistories[t]);
                 
-                // Draw tracer (fading history trail)
-                for (int age = BandHistory::kHistorySize - 1; age >= 1; --age)
+                // Aggregated even when expanded, to place the group's label
+                // Levels add as power, pan shares average weighted by each member's band energy
+                for (size_t b = 0; b < static_cast<size_t>(numBands); ++b)
                 {
-                    float oldX = hist.get(age);
-                    float newX = hist.get(age - 1);
-                    
-                    // Skip if no movement
-                    if (std::abs(oldX - newX) < 0.001f) continue;
-                   
-                    // alpha * decay factor * base intensity
-                    float tracerAlpha = alpha * (1.0f - static_cast<float>(age) / static_cast<float>(BandHistory::kHistorySize)) * 0.7f;
-                    
-                    // Draw tracer line connecting old and new positions
-                    addLine(oldX, avgY, z, newX, avgY, z, cr, cg, cb, tracerAlpha);
+                    float energy = frame.left[b] * frame.left[b] + frame.right[b] * frame.right[b];
+                    agg.left[b] += frame.left[b] * frame.left[b];
+                    agg.right[b] += frame.right[b] * frame.right[b];
+                    for (size_t k = 0; k < kPanBuckets; ++k)
+                        agg.pan[b * kPanBuckets + k] += frame.pan[b * kPanBuckets + k] * energy;
                 }
-                
-                // Draw current position bar (fixed width, clamped to box)
-                float lx = juce::jlimit(-1.0f, 1.0f - bandWidth * 2, centerX - bandWidth);
-                float rx = juce::jlimit(-1.0f + bandWidth * 2, 1.0f, centerX + bandWidth);
-                
-                // Filled bar from floor to amplitude
-                addQuad(lx, -1.0f, z - 0.02f,
-                       rx, -1.0f, z - 0.02f,
-                       rx, avgY, z - 0.02f,
-                       lx, avgY, z - 0.02f,
-                       cr * 0.8f, cg * 0.8f, cb, alpha * 0.5f);
-                
-                addQuad(lx, -1.0f, z + 0.02f,
-                       rx, -1.0f, z + 0.02f,
-                       rx, avgY, z + 0.02f,
-                       lx, avgY, z + 0.02f,
-                       cr, cg * 0.8f, cb * 0.8f, alpha * 0.5f);
-                
-                // Top cap
-                addQuad(lx, avgY, z - 0.02f,
-                       rx, avgY, z - 0.02f,
-                       rx, avgY, z + 0.02f,
-                       lx, avgY, z + 0.02f,
-                       cr, cg, cb, alpha * 0.4f);
-                
-                // Bright edge lines
-                addLine(lx, -1.0f, z, lx, avgY, z, cr * 0.9f, cg, cb, alpha);
-                addLine(rx, -1.0f, z, rx, avgY, z, cr, cg, cb * 0.9f, alpha);
-                addLine(lx, avgY, z, rx, avgY, z, cr, cg, cb, alpha);
+                red += frame.colour.getFloatRed();
+                green += frame.colour.getFloatGreen();
+                blue += frame.colour.getFloatBlue();
+                ++members;
             }
             
-            // Connect bands with lines
-            float prevX = 0, prevY = -1, prevZ = -1;
-            bool first = true;
+            clusterAnchors[c].members.store(members, std::memory_order_relaxed);
+            if (members == 0) continue;
             
-            for (int band = 0; band < numBands; ++band)
+            size_t loudest = 0;
+            for (size_t b = 0; b < static_cast<size_t>(numBands); ++b)
             {
-                float left, right;
-                track.getBand(static_cast<size_t>(band), left, right);
-                
-                float z = -1.0f + (static_cast<float>(band) + 0.5f) / static_cast<float>(numBands) * 2.0f;
-                float avgY = (levelToY(left) + levelToY(right)) * 0.5f;
+                float energy = agg.left[b] + agg.right[b];
+                agg.left[b] = std::sqrt(agg.left[b]);
+                agg.right[b] = std::sqrt(agg.right[b]);
+                if (energy > 0.0f)
+                    for (size_t k = 0; k < kPanBuckets; ++k)
+                        agg.pan[b * kPanBuckets + k] /= energy;
+                if (std::max(agg.left[b], agg.right[b]) > std::max(agg.left[loudest], agg.right[loudest]))
+                    loudest = b;
+            }
+            
+            float n = static_cast<float>(members);
+            agg.colour = juce::Colour::fromFloatRGBA(red / n, green / n, blue / n, 1.0f);
+            publishClusterAnchor(c, agg, loudest, numBands, rangeVal);
+            if (!isExpanded)
+                addTrackBars(agg, numBands, rangeVal, showSpread, clusterHistories[c]);
+        }
+    }
+    
+    // Top of the group's loudest aggregated band, where its label is drawn and picked
+    void publishClusterAnchor(size_t c, const TrackFrame& agg, size_t band, int numBands, float rangeVal)
+    {
+        float l = agg.left[band], r = agg.right[band];
+        auto& a = clusterAnchors[c];
+        a.x.store((r - l) / (l + r + 0.0001f), std::memory_order_relaxed);
+        a.y.store((levelToY(l, rangeVal) + levelToY(r, rangeVal)) * 0.5f, std::memory_order_relaxed);
+        a.z.store(-1.0f + (static_cast<float>(band) + 0.5f) / static_cast<float>(numBands) * 2.0f,
+                  std::memory_order_relaxed);
+        a.colour.store(agg.colour.brighter(0.3f).getARGB(), std::memory_order_relaxed);
+    }
+    
+    // Same log-frequency depth axis as the bands, 20Hz at -1 and 20kHz at +1
+    static float frequencyToZ(float hz)
+    {
+        return -1.0f + 2.0f * std::log10(juce::jlimit(20.0f, 20000.0f, hz) / 20.0f) / 3.0f;
+    }
+    
+    // Each sender's tonal peaks as a stem with a tick at its level. Peaks within
+    // kCollisionSemitones of another track's peak are drawn in the warning colour
+    // and joined to the closest one.
+    void addTonalPeaks(float rangeVal)
+    {
+        peakFinder.clear();
+        for (size_t t = 0; t < kMaxTracks; ++t)
+        {
+            if (!active[t]) continue;
+            const auto& track = sharedData.getTrack(static_cast<int>(t));
+            int n = juce::jlimit(0, static_cast<int>(kMaxPeaks), track.numPeaks.load(std::memory_order_relaxed));
+            for (int p = 0; p < n; ++p)
+            {
+                float freq = 0.0f, level = 0.0f, pan = 0.0f;
+                track.getPeak(static_cast<size_t>(p), freq, level, pan);
+                // Peaks under the floor can't be seen, so they shouldn't be flagged either
+                if (levelToY(level, rangeVal) > -0.95f)
+                    peakFinder.add(static_cast<int>(t), freq, level, pan);
+            }
+        }
+        peakFinder.find(kCollisionSemitones);
+        
+        auto wc = juce::Colour(Colors::warning);
+        constexpr float tick = 0.025f;
+        
+        for (size_t i = 0; i < peakFinder.size(); ++i)
+        {
+            const auto& p = peakFinder[i];
+            float x = juce::jlimit(-1.0f, 1.0f, p.pan);
+            float y = levelToY(p.level, rangeVal);
+            float z = frequencyToZ(p.frequency);
+            
+            bool collides = p.partner >= 0;
+            auto col = collides ? wc : frames[static_cast<size_t>(p.track)].colour.brighter(0.3f);
+            float r = col.getFloatRed(), g = col.getFloatGreen(), b = col.getFloatBlue();
+            float alpha = collides ? 0.9f : 0.5f;
+            
+            addLine(x, -1.0f, z, x, y, z, r, g, b, alpha * 0.5f);
+            addLine(x - tick, y, z, x + tick, y, z, r, g, b, alpha);
+            
+            // Join each peak to its partner. A mutual pair is drawn once, from its
+            // lower-frequency peak; a one-way link (the partner's closest is another
+            // peak) is drawn from this side, or its partner would never show it.
+            const auto partner = static_cast<size_t>(p.partner);
+            if (collides && (peakFinder[partner].partner != static_cast<int>(i) || partner > i))
+            {
+                const auto& q = peakFinder[partner];
+                addLine(x, y, z, juce::jlimit(-1.0f, 1.0f, q.pan), levelToY(q.level, rangeVal),
+                        frequencyToZ(q.frequency), r, g, b, alpha);
+            }
+        }
+    }
+    
+    // Captured levels of B on a common grid, each band coloured by its B - A difference
+    void addDiffTracks(const SessionDiffResult& diff, float rangeVal)
+    {
+        int numBands = 0;
+        for (auto n : diff.numBands) numBands = std::max(numBands, n);
+        if (numBands == 0) return;
+        
+        std::array<float, kMaxBands> means{}, rms{};
+        for (size_t t = 0; t < kMaxTracks; ++t)
+        {
+            int trackBands = diff.numBands[t];
+            if (trackBands == 0) continue;
+            
+            auto& frame = frames[t];
+            frame.colour = juce::Colour(Colors::text);
+            resampler.process(trackBands, numBands, diff.leftB[t].data(), frame.left.data());
+            resampler.process(trackBands, numBands, diff.rightB[t].data(), frame.right.data());
+            resampler.processMean(trackBands, numBands, diff.meanDiffDb[t].data(), means.data());
+            resampler.process(trackBands, numBands, diff.rmsDiffDb[t].data(), rms.data());  // Power mean keeps it an RMS
+            
+            addTrackBars(frame, numBands, rangeVal, false, bandHistories[t], means.data(), rms.data());
+        }
+    }
+    
+    // Diverging map from neutral grey. Strength follows the RMS change, which doesn't
+    // cancel; hue is blue for quieter in B, red for louder, and yellow when the band
+    // moved both ways so much that the mean hides it.
+    static void diffToColour(float meanDb, float rmsDb, float& r, float& g, float& b)
+    {
+        float t = juce::jlimit(0.0f, 1.0f, rmsDb / kDiffColourRangeDb);
+        const float nr = 0.75f, ng = 0.75f, nb = 0.75f;
+        float tr = 1.0f, tg = 0.25f, tb = 0.2f;
+        if (std::abs(meanDb) < 0.5f * rmsDb) { tr = 1.0f; tg = 0.85f; tb = 0.2f; }
+        else if (meanDb < 0.0f)              { tr = 0.2f; tg = 0.5f;  tb = 1.0f; }
+        
+        r = nr + (tr - nr) * t;  g = ng + (tg - ng) * t;  b = nb + (tb - nb) * t;
+    }
+    
+    void addTrackBars(const TrackFrame& frame, int numBands, float rangeVal, bool showSpread,
+                      std::array<BandHistory, kMaxBands>& histories,
+                      const float* bandDiffDb = nullptr, const float* bandRmsDb = nullptr)
+    {
+        auto col = frame.colour;
+        float trackR = std::min(1.0f, col.getFloatRed() * 1.3f);
+        float trackG = std::min(1.0f, col.getFloatGreen() * 1.3f);
+        float trackB = std::min(1.0f, col.getFloatBlue() * 1.3f);
+        
+        // Fixed width for all bands
+        constexpr float bandWidth = 0.03f;
+        
+        for (int band = 0; band < numBands; ++band)
+        {
+            float left = frame.left[static_cast<size_t>(band)];
+            float right = frame.right[static_cast<size_t>(band)];
+            
+            float cr = trackR, cg = trackG, cb = trackB;
+            if (bandDiffDb != nullptr && bandRmsDb != nullptr)
+                diffToColour(bandDiffDb[band], bandRmsDb[band], cr, cg, cb);
+            
+            float z = -1.0f + (static_cast<float>(band) + 0.5f) / static_cast<float>(numBands) * 2.0f;
+            float ly = levelToY(left, rangeVal);
+            float ry = levelToY(right, rangeVal);
+            float avgY = (ly + ry) * 0.5f;
+            
+            if (avgY < -0.95f) continue;
+            
+            // Pan position: -1 = full left, +1 = full right
+            float total = left + right + 0.0001f;
+            float balance = (right - left) / total;
+            float centerX = balance;  // Full range -1 to +1
+            
+            // Update history for this band
+            auto& hist = histories[static_cast<size_t>(band)];
+            hist.push(centerX);
+            
+            float alpha = juce::jlimit(0.5f, 1.0f, avgY * 0.5f + 0.7f);
+            
+            // New Opacity Logic: 
+            // 0 to -60dB -> Full opacity based on alpha calc above
+            // -60 to -90dB -> Fade to 0
+            // We need to recover dB from avgY? No, use the raw level.
+            // Re-calculate dB for opacity check using max of L/R
+            float maxLevel = std::max(left, right);
+            float db = juce::Decibels::gainToDecibels(maxLevel, -120.0f);
+            
+            if (db < -50.0f)
+            {
+                float fade = juce::jmap(db, -90.0f, -50.0f, 0.0f, 1.0f);
+                alpha *= std::max(0.0f, fade);
+            }
+            
+            if (alpha < 0.01f) continue;
+            
+            // Draw tracer (fading history trail)
+            for (int age = BandHistory::kHistorySize - 1; age >= 1; --age)
+            {
+                float oldX = hist.get(age);
+                float newX = hist.get(age - 1);
                 
-                if (avgY < -0.95f) { first = true; continue; }
+                // Skip if no movement
+                if (std::abs(oldX - newX) < 0.001f) continue;
+               
+                // alpha * decay factor * base intensity
+                float tracerAlpha = alpha * (1.0f - static_cast<float>(age) / static_cast<float>(BandHistory::kHistorySize)) * 0.7f;
                 
-                float total = left + right + 0.0001f;
-                float balance = (right - left) / total;
-                float centerX = balance;  // Full range -1 to +1
+                // Draw tracer line connecting old and new positions
+                addLine(oldX, avgY, z, newX, avgY, z, cr, cg, cb, tracerAlpha);
+            }
+            
+            // Draw current position bar (fixed width, clamped to box)
+            float lx = juce::jlimit(-1.0f, 1.0f - bandWidth * 2, centerX - bandWidth);
+            float rx = juce::jlimit(-1.0f + bandWidth * 2, 1.0f, centerX + bandWidth);
+            
+            // Filled bar from floor to amplitude
+            addQuad(lx, -1.0f, z - 0.02f,
+                   rx, -1.0f, z - 0.02f,
+                   rx, avgY, z - 0.02f,
+                   lx, avgY, z - 0.02f,
+                   cr * 0.8f, cg * 0.8f, cb, alpha * 0.5f);
+            
+            addQuad(lx, -1.0f, z + 0.02f,
+                   rx, -1.0f, z + 0.02f,
+                   rx, avgY, z + 0.02f,
+                   lx, avgY, z + 0.02f,
+                   cr, cg * 0.8f, cb * 0.8f, alpha * 0.5f);
+            
+            // Top cap
+            addQuad(lx, avgY, z - 0.02f,
+                   rx, avgY, z - 0.02f,
+                   rx, avgY, z + 0.02f,
+                   lx, avgY, z + 0.02f,
+                   cr, cg, cb, alpha * 0.4f);
+            
+            // Stereo spread within the band: one strip per pan bucket just above
+            // the top cap, opacity following that bucket's share of the energy
+            if (showSpread)
+            {
+                const float* shares = frame.pan.data() + static_cast<size_t>(band) * kPanBuckets;
+                constexpr float bucketWidth = 2.0f / static_cast<float>(kPanBuckets);
+                float spreadY = avgY + 0.004f;
                 
-                if (!first)
+                for (size_t k = 0; k < kPanBuckets; ++k)
                 {
-                    addLine(prevX, prevY, prevZ, centerX, avgY, z, cr, cg, cb, 0.4f);
+                    if (shares[k] < 0.03f) continue;
+                    
+                    float bx0 = -1.0f + static_cast<float>(k) * bucketWidth;
+                    float bx1 = bx0 + bucketWidth;
+                    addQuad(bx0, spreadY, z - 0.012f,
+                           bx1, spreadY, z - 0.012f,
+                           bx1, spreadY, z + 0.012f,
+                           bx0, spreadY, z + 0.012f,
+                           cr, cg, cb, alpha * std::min(1.0f, shares[k] * 1.5f) * 0.6f);
                 }
-                
-                prevX = centerX;
-                prevY = avgY;
-                prevZ = z;
-                first = false;
             }
+            
+            // Bright edge lines
+            addLine(lx, -1.0f, z, lx, avgY, z, cr * 0.9f, cg, cb, alpha);
+            addLine(rx, -1.0f, z, rx, avgY, z, cr, cg, cb * 0.9f, alpha);
+            addLine(lx, avgY, z, rx, avgY, z, cr, cg, cb, alpha);
+        }
+        
+        // Connect bands with lines
+        float prevX = 0, prevY = -1, prevZ = -1;
+        bool first = true;
+        
+        for (int band = 0; band < numBands; ++band)
+        {
+            float left = frame.left[static_cast<size_t>(band)];
+            float right = frame.right[static_cast<size_t>(band)];
+            
+            float z = -1.0f + (static_cast<float>(band) + 0.5f) / static_cast<float>(numBands) * 2.0f;
+            float avgY = (levelToY(left, rangeVal) + levelToY(right, rangeVal)) * 0.5f;
+            
+            if (avgY < -0.95f) { first = true; continue; }
+            
+            float total = left + right + 0.0001f;
+            float balance = (right - left) / total;
+            float centerX = balance;  // Full range -1 to +1
+            
+            if (!first)
+            {
+                addLine(prevX, prevY, prevZ, centerX, avgY, z, trackR, trackG, trackB, 0.4f);
+            }
+            
+            prevX = centerX;
+            prevY = avgY;
+            prevZ = z;
+            first = false;
         }
     }
     
-    void drawVerts()
+    void drawVerts(const std::array<float, 16>& proj, const std::array<float, 16>& view, float scale)
     {
         using namespace juce::gl;
         
@@ -647,32 +1156,127 @@ private:
         }
         
         // Draw lines on top
-        if (!lineVerts.empty())
+        if (!lineSegs.empty())
         {
-            if (lineVbo == 0) glGenBuffers(1, &lineVbo);
-            
-            glBindBuffer(GL_ARRAY_BUFFER, lineVbo);
-            glBufferData(GL_ARRAY_BUFFER, 
-                        static_cast<GLsizeiptr>(lineVerts.size() * sizeof(Vtx)), 
-                        lineVerts.data(), GL_STREAM_DRAW);
-            
-            glEnableVertexAttribArray(pa);
-            glEnableVertexAttribArray(ca);
-            
-            glVertexAttribPointer(pa, 3, GL_FLOAT, GL_FALSE, sizeof(Vtx), nullptr);
-            glVertexAttribPointer(ca, 4, GL_FLOAT, GL_FALSE, sizeof(Vtx), 
-                                reinterpret_cast<void*>(3 * sizeof(float)));
-            
-            glLineWidth(2.0f);
-            glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(lineVerts.size()));
-            
-            glDisableVertexAttribArray(pa);
-            glDisableVertexAttribArray(ca);
+            if (canDrawThickLines())
+                drawThickLines(proj, view, scale);
+            else
+                drawThinLines(pa, ca);
         }
         
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
     
+    bool canDrawThickLines() const
+    {
+        using namespace juce::gl;
+        
+        if (lineShader == nullptr || lineShader->getProgramID() == 0) return false;
+        if (glDrawArraysInstanced == nullptr || glVertexAttribDivisor == nullptr) return false;
+        
+        for (auto* a : { lCorner.get(), lStart.get(), lEnd.get(), lCol.get() })
+            if (a == nullptr || a->attributeID < 0) return false;
+        return true;
+    }
+    
+    void drawThickLines(const std::array<float, 16>& proj, const std::array<float, 16>& view, float scale)
+    {
+        using namespace juce::gl;
+        
+        constexpr float lineWidth = 1.5f;  // Logical pixels
+        
+        lineShader->use();
+        if (lProj != nullptr) lProj->setMatrix4(proj.data(), 1, false);
+        if (lView != nullptr) lView->setMatrix4(view.data(), 1, false);
+        if (lViewport != nullptr) lViewport->set(scale * static_cast<float>(getWidth()),
+                                                 scale * static_cast<float>(getHeight()));
+        if (lWidth != nullptr) lWidth->set(lineWidth * scale);
+        
+        GLuint cornerA = static_cast<GLuint>(lCorner->attributeID);
+        GLuint startA = static_cast<GLuint>(lStart->attributeID);
+        GLuint endA = static_cast<GLuint>(lEnd->attributeID);
+        GLuint colA = static_cast<GLuint>(lCol->attributeID);
+        
+        // Shared quad corners: x picks the endpoint, y the side of the centre line
+        if (cornerVbo == 0)
+        {
+            const float corners[] = { 0.0f, -1.0f,  0.0f, 1.0f,  1.0f, -1.0f,  1.0f, 1.0f };
+            glGenBuffers(1, &cornerVbo);
+            glBindBuffer(GL_ARRAY_BUFFER, cornerVbo);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        }
+        
+        glBindBuffer(GL_ARRAY_BUFFER, cornerVbo);
+        glEnableVertexAttribArray(cornerA);
+        glVertexAttribPointer(cornerA, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+        
+        if (lineVbo == 0) glGenBuffers(1, &lineVbo);
+        glBindBuffer(GL_ARRAY_BUFFER, lineVbo);
+        glBufferData(GL_ARRAY_BUFFER, 
+                    static_cast<GLsizeiptr>(lineSegs.size() * sizeof(LineSeg)), 
+                    lineSegs.data(), GL_STREAM_DRAW);
+        
+        for (auto a : { startA, endA, colA })
+        {
+            glEnableVertexAttribArray(a);
+            glVertexAttribDivisor(a, 1);
+        }
+        glVertexAttribPointer(startA, 3, GL_FLOAT, GL_FALSE, sizeof(LineSeg), nullptr);
+        glVertexAttribPointer(endA, 3, GL_FLOAT, GL_FALSE, sizeof(LineSeg), 
+                            reinterpret_cast<void*>(3 * sizeof(float)));
+        glVertexAttribPointer(colA, 4, GL_FLOAT, GL_FALSE, sizeof(LineSeg), 
+                            reinterpret_cast<void*>(6 * sizeof(float)));
+        
+        // Lines are still depth-tested against the bars but don't write depth, so a
+        // line's soft fringe can't cut notches into lines drawn after it
+        glDepthMask(GL_FALSE);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(lineSegs.size()));
+        glDepthMask(GL_TRUE);
+        
+        // Divisors are per attribute slot, not per program, so reset them for the bar shader
+        for (auto a : { startA, endA, colA })
+        {
+            glVertexAttribDivisor(a, 0);
+            glDisableVertexAttribArray(a);
+        }
+        glDisableVertexAttribArray(cornerA);
+        
+        shader->use();
+    }
+    
+    // Fallback for contexts without instancing: plain GL_LINES at whatever width the driver gives
+    void drawThinLines(GLuint pa, GLuint ca)
+    {
+        using namespace juce::gl;
+        
+        lineVerts.clear();
+        lineVerts.reserve(lineSegs.size() * 2);
+        for (const auto& l : lineSegs)
+        {
+            lineVerts.push_back({l.x1, l.y1, l.z1, l.r, l.g, l.b, l.a});
+            lineVerts.push_back({l.x2, l.y2, l.z2, l.r, l.g, l.b, l.a});
+        }
+        
+        if (lineVbo == 0) glGenBuffers(1, &lineVbo);
+        
+        glBindBuffer(GL_ARRAY_BUFFER, lineVbo);
+        glBufferData(GL_ARRAY_BUFFER, 
+                    static_cast<GLsizeiptr>(lineVerts.size() * sizeof(Vtx)), 
+                    lineVerts.data(), GL_STREAM_DRAW);
+        
+        glEnableVertexAttribArray(pa);
+        glEnableVertexAttribArray(ca);
+        
+        glVertexAttribPointer(pa, 3, GL_FLOAT, GL_FALSE, sizeof(Vtx), nullptr);
+        glVertexAttribPointer(ca, 4, GL_FLOAT, GL_FALSE, sizeof(Vtx), 
+                            reinterpret_cast<void*>(3 * sizeof(float)));
+        
+        glDrawArrays(GL_LINES, 0, static_cast<GLsizei>(lineVerts.size()));
+        
+        glDisableVertexAttribArray(pa);
+        glDisableVertexAttribArray(ca);
+    }
+    
     ITrackDataProvider& sharedData;
     std::atomic<float>* rangePtr = nullptr;
     juce::OpenGLContext ctx;
@@ -681,10 +1285,55 @@ private:
     std::unique_ptr<juce::OpenGLShaderProgram::Uniform> uProj, uView;
     std::unique_ptr<juce::OpenGLShaderProgram::Attribute> aPos, aCol;
     
-    std::vector<Vtx> lineVerts;
+    std::unique_ptr<juce::OpenGLShaderProgram> lineShader;
+    std::unique_ptr<juce::OpenGLShaderProgram::Uniform> lProj, lView, lViewport, lWidth;
+    std::unique_ptr<juce::OpenGLShaderProgram::Attribute> lCorner, lStart, lEnd, lCol;
+    
+    std::vector<LineSeg> lineSegs;
+    std::vector<Vtx> lineVerts;  // Only used by the GL_LINES fallback
     std::vector<Vtx> triVerts;
+    
+    // Maps each sender's band layout onto the shared display grid
+    BandResampler resampler;
+    
+    std::array<TrackFrame, kMaxTracks> frames;  // Levels and pan shares on the display grid
+    std::array<bool, kMaxTracks> active{};
+    
+    // Track grouping for large sessions
+    TrackClusterer clusterer;
+    std::array<TrackClusterer::Features, kMaxTracks> features{};
+    std::array<TrackFrame, TrackClusterer::kMaxClusters> clusterFrames;
+    std::array<std::array<BandHistory, kMaxBands>, TrackClusterer::kMaxClusters> clusterHistories;
+    std::array<std::atomic<int>, kMaxTracks> trackClusters{};  // Published for the message thread
+    
+    struct ClusterAnchor
+    {
+        std::atomic<float> x{ 0.0f }, y{ 0.0f }, z{ 0.0f };
+        std::atomic<uint32_t> colour{ 0xFFFFFFFF };
+        std::atomic<int> members{ 0 };
+    };
+    std::array<ClusterAnchor, TrackClusterer::kMaxClusters> clusterAnchors;  // For labels and picking
+    static constexpr float kClusterPickRadius = 28.0f;
+    std::atomic<bool> clustering{ false };
+    std::atomic<uint32_t> expandedClusters{ 0 };
+    std::array<uint32_t, TrackClusterer::kMaxClusters> clusterGenerations{};  // Last seen per slot, render thread only
+    
+    // Tonal peak collisions across tracks. Notes a semitone apart must count, and at
+    // bass frequencies the ~11 Hz bins make peak estimates wobble by a good part of
+    // a semitone, so the cut-off sits well above one.
+    static constexpr float kCollisionSemitones = 1.5f;
+    PeakCollisionFinder peakFinder;
+    
+    // Capture comparison shown instead of live data while set
+    static constexpr float kDiffColourRangeDb = 12.0f;
+    std::shared_ptr<const SessionDiffResult> diffOverlay;
+    
+    // Captured frame shown instead of live data while set
+    std::shared_ptr<const CaptureFrame> replayFrame;
+    juce::String replayLabel;
     GLuint lineVbo = 0;
     GLuint triVbo = 0;
+    GLuint cornerVbo = 0;
     
     // History for tracer effect - per track, per band
     std::array<std::array<BandHistory, kMaxBands>, kMaxTracks> bandHistories;
@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+    PeakCollisions.h - Flags near-coincident tonal peaks across tracks
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedDataManager.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+// Band levels can't tell two bass notes a semitone apart from one louder note,
+// but the senders' sparse peak lists can. Sorting every active track's peaks by
+// frequency puts candidates next to each other, so finding pairs from different
+// tracks within a tolerance costs O(N log N) for N = tracks x peaks.
+class PeakCollisionFinder
+{
+public:
+    struct Peak
+    {
+        float frequency = 0.0f, level = 0.0f, pan = 0.0f;
+        int track = -1;
+        int partner = -1;  // Index of the closest colliding peak after find(), -1 if none
+    };
+
+    static constexpr size_t kCapacity = kMaxTracks * kMaxPeaks;
+
+    void clear() { numPeaks = 0; }
+
+    void add(int track, float frequency, float level, float pan)
+    {
+        if (numPeaks >= kCapacity || frequency <= 0.0f) return;
+        peaks[numPeaks++] = { frequency, level, pan, track, -1 };
+    }
+
+    // Sorts by frequency and links each peak to the nearest peak of another track
+    // within `toleranceSemitones`
+    void find(float toleranceSemitones)
+    {
+        std::sort(peaks.begin(), peaks.begin() + static_cast<std::ptrdiff_t>(numPeaks),
+                  [](const Peak& a, const Peak& b) { return a.frequency < b.frequency; });
+
+        const float maxRatio = std::pow(2.0f, toleranceSemitones / 12.0f);
+        std::array<float, kCapacity> closest;
+        closest.fill(maxRatio);
+
+        for (size_t i = 0; i < numPeaks; ++i)
+        {
+            // Sorted, so the window ends at the first peak past the tolerance
+            for (size_t j = i + 1; j < numPeaks; ++j)
+            {
+                float ratio = peaks[j].frequency / peaks[i].frequency;
+                if (ratio > maxRatio) break;
+                if (peaks[j].track == peaks[i].track) continue;
+
+                if (ratio < closest[i]) { closest[i] = ratio; peaks[i].partner = static_cast<int>(j); }
+                if (ratio < closest[j]) { closest[j] = ratio; peaks[j].partner = static_cast<int>(i); }
+            }
+        }
+    }
+
+    size_t size() const { return numPeaks; }
+    const Peak& operator[](size_t i) const { return peaks[i]; }
+
+private:
+    std::array<Peak, kCapacity> peaks{};
+    size_t numPeaks = 0;
+};
@@ -115,22 +115,55 @@ void TrackList::paint(juce::Graphics& g)
 
     g.drawText(text, 10, 0, 100, getHeight(), juce::Justification::centredLeft);
     
-    int x = 115;
-    for (size_t i = 0; i < kMaxTracks && x < getWidth() - 20; ++i)
+    g.setFont(juce::FontOptions(9.0f, juce::Font::bold));
+    int index = 0;
+    for (size_t i = 0; i < kMaxTracks; ++i)
     {
-        if (data.getTrack(static_cast<int>(i)).isActive.load())
+        const auto& track = data.getTrack(static_cast<int>(i));
+        if (!track.isActive.load()) continue;
+        
+        auto dot = dotBounds(index++, count);
+        g.setColour(track.getColor());
+        g.fillEllipse(dot);
+        
+        int cluster = clusterOf ? clusterOf(static_cast<int>(i)) : -1;
+        if (cluster >= 0 && dot.getWidth() >= 10.0f)
+        {
+            g.setColour(juce::Colours::black.withAlpha(0.8f));
+            g.drawText(juce::String(cluster + 1), dot, juce::Justification::centred);
+        }
+    }
+}
+
+// Dots shrink and tighten so every active track fits, however many there are
+juce::Rectangle<float> TrackList::dotBounds(int index, int numDots) const
+{
+    float avail = static_cast<float>(getWidth() - 115 - 6);
+    float step = juce::jlimit(6.0f, 16.0f, avail / static_cast<float>(juce::jmax(1, numDots)));
+    float size = juce::jmin(12.0f, step - 2.0f);
+    return { 115.0f + static_cast<float>(index) * step, static_cast<float>(getHeight()) * 0.5f - size * 0.5f, size, size };
+}
+
+void TrackList::mouseDown(const juce::MouseEvent& e)
+{
+    // Mirrors the dot layout in paint()
+    int index = 0;
+    for (size_t i = 0; i < kMaxTracks; ++i)
+    {
+        if (!data.getTrack(static_cast<int>(i)).isActive.load()) continue;
+        
+        if (dotBounds(index++, count).expanded(1.0f, 6.0f).contains(e.position))
         {
-            g.setColour(data.getTrack(static_cast<int>(i)).getColor());
-            g.fillEllipse(static_cast<float>(x), static_cast<float>(getHeight()/2 - 6), 12.0f, 12.0f);
-            x += 16;
+            if (onTrackClicked) onTrackClicked(static_cast<int>(i));
+            return;
         }
     }
 }
 
 void TrackList::timerCallback()
 {
-    int n = data.getActiveCount();
-    if (n != count) { count = n; repaint(); }
+    count = data.getActiveCount();
+    repaint();  // Colours and group numbers change without the count changing
 }
 
 //==============================================================================
@@ -140,7 +173,7 @@ SpectralImagerAudioProcessorEditor::SpectralImagerAudioProcessorEditor(SpectralI
     // Set size first
     setSize(640, 750);
     setResizable(true, true);
-    setResizeLimits(600, 450, 1400, 1000);
+    setResizeLimits(680, 450, 1400, 1000);
     
     // Title
     title.setText("Spectral Imager 3D", juce::dontSendNotification);
@@ -205,6 +238,31 @@ SpectralImagerAudioProcessorEditor::SpectralImagerAudioProcessorEditor(SpectralI
     resetBtn.onClick = [this] { if (renderer != nullptr) renderer->resetView(); };
     addChildComponent(resetBtn);
     
+    // Track grouping - click a track dot to expand or collapse its group
+    groupBtn.setColour(juce::ToggleButton::textColourId, UI::text);
+    groupBtn.setColour(juce::ToggleButton::tickColourId, UI::text);
+    groupBtn.setColour(juce::ToggleButton::tickDisabledColourId, UI::textDim);
+    groupBtn.onClick = [this] {
+        if (renderer != nullptr) renderer->setClustering(groupBtn.getToggleState());
+    };
+    addChildComponent(groupBtn);
+    
+    // Session capture: record the frame stream, then diff two captures or bounces
+    for (auto* btn : { &recordBtn, &diffBtn, &findBtn })
+    {
+        btn->setColour(juce::TextButton::buttonColourId, UI::panel);
+        btn->setColour(juce::TextButton::textColourOffId, UI::text);
+        addChildComponent(*btn);
+    }
+    recordBtn.onClick = [this] { toggleRecording(); };
+    if (proc.getRecorder().isRecording())
+    {
+        recordBtn.setButtonText("Stop");
+        recordBtn.setColour(juce::TextButton::buttonColourId, juce::Colour(Colors::warning));
+    }
+    diffBtn.onClick = [this] { chooseDiffFiles(); };
+    findBtn.onClick = [this] { findConflicts(); };
+    
     // Range slider
     rangeSlider.setSliderStyle(juce::Slider::LinearHorizontal);
     rangeSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 50, 20);
@@ -256,6 +314,7 @@ SpectralImagerAudioProcessorEditor::SpectralImagerAudioProcessorEditor(SpectralI
         
         trackList = std::make_unique<TrackList>(proc.getSharedData());
         addChildComponent(*trackList);
+        attachTrackList();
     }
 #else
     if (proc.getMode() == PluginMode::Receiver)
@@ -266,6 +325,7 @@ SpectralImagerAudioProcessorEditor::SpectralImagerAudioProcessorEditor(SpectralI
         
         trackList = std::make_unique<TrackList>(proc.getSharedData());
         addChildComponent(*trackList);
+        attachTrackList();
     }
 #endif
     
@@ -277,6 +337,11 @@ SpectralImagerAudioProcessorEditor::SpectralImagerAudioProcessorEditor(SpectralI
 SpectralImagerAudioProcessorEditor::~SpectralImagerAudioProcessorEditor()
 {
     stopTimer();
+    
+    // Jobs poll these flags; waiting for them keeps their code from outliving the module
+    if (diffCancel != nullptr) diffCancel->store(true);
+    if (findCancel != nullptr) findCancel->store(true);
+    workers.removeAllJobs(true, 30000);
 }
 
 void SpectralImagerAudioProcessorEditor::paint(juce::Graphics& g)
@@ -303,6 +368,10 @@ void SpectralImagerAudioProcessorEditor::resized()
 #ifndef SI3D_16CH_UNIFIED
     modeBox.setBounds(header.removeFromLeft(120).reduced(5, 12));
 #endif
+    groupBtn.setBounds(header.removeFromRight(90).reduced(5, 12));
+    findBtn.setBounds(header.removeFromRight(80).reduced(5, 12));
+    diffBtn.setBounds(header.removeFromRight(70).reduced(5, 12));
+    recordBtn.setBounds(header.removeFromRight(60).reduced(5, 12));
     
     b.reduce(10, 10);
     
@@ -330,7 +399,8 @@ void SpectralImagerAudioProcessorEditor::resized()
         {
             auto bottom = b.removeFromBottom(36);
             
-            trackList->setBounds(bottom.removeFromLeft(180));
+            // Whatever the controls on the right leave, so more track dots fit
+            trackList->setBounds(bottom.removeFromLeft(juce::jmax(180, bottom.getWidth() - 405)));
             bottom.removeFromLeft(10);
             
             rangeLabel.setBounds(bottom.removeFromLeft(45));
@@ -354,9 +424,9 @@ void SpectralImagerAudioProcessorEditor::timerCallback()
     if (proc.getMode() == PluginMode::Sender)
     {
         int s = proc.getSlot();
-        juce::String status = s >= 0
-            ? "Status: Active on slot " + juce::String(s + 1)
-            : "Status: No slot available";
+        juce::String status = s >= 0 ? "Status: Active on slot " + juce::String(s + 1)
+                            : !proc.isPrepared() ? "Status: Waiting for audio"
+                            : "Status: No slot available";
         if (statusLbl.getText() != status)
             statusLbl.setText(status, juce::dontSendNotification);
     }
@@ -372,6 +442,277 @@ void SpectralImagerAudioProcessorEditor::timerCallback()
 #endif
 }
 
+void SpectralImagerAudioProcessorEditor::attachTrackList()
+{
+    trackList->onTrackClicked = [this](int slot) {
+        if (renderer != nullptr && renderer->isClustering()) renderer->toggleClusterOfTrack(slot);
+    };
+    trackList->clusterOf = [this](int slot) {
+        return renderer != nullptr ? renderer->getClusterOfTrack(slot) : -1;
+    };
+    if (renderer != nullptr) renderer->setClustering(groupBtn.getToggleState());
+}
+
+void SpectralImagerAudioProcessorEditor::toggleRecording()
+{
+    auto& recorder = proc.getRecorder();
+    if (recorder.isRecording())
+    {
+        recorder.stop();
+    }
+    else
+    {
+        auto folder = CaptureFormat::getDefaultFolder();
+        folder.createDirectory();
+        auto name = "Capture " + juce::Time::getCurrentTime().formatted("%Y-%m-%d %H-%M-%S");
+        recorder.start(folder.getChildFile(name + CaptureFormat::getFileExtension()));
+    }
+    
+    bool recording = recorder.isRecording();
+    recordBtn.setButtonText(recording ? "Stop" : "Rec");
+    recordBtn.setColour(juce::TextButton::buttonColourId, recording ? juce::Colour(Colors::warning) : UI::panel);
+}
+
+void SpectralImagerAudioProcessorEditor::chooseDiffFiles()
+{
+    if (renderer == nullptr) return;
+    
+    // Second click leaves the diff view
+    if (renderer->hasDiffOverlay())
+    {
+        renderer->setDiffOverlay(nullptr);
+        diffBtn.setButtonText("Diff...");
+        return;
+    }
+    
+    juce::PopupMenu menu;
+    menu.addItem(1, "Align by time");
+    menu.addItem(2, "Align by energy correlation");
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&diffBtn), [this](int choice) {
+        if (choice == 1) pickDiffFiles(SessionDiff::Alignment::Time);
+        else if (choice == 2) pickDiffFiles(SessionDiff::Alignment::EnergyCorrelation);
+    });
+}
+
+void SpectralImagerAudioProcessorEditor::pickDiffFiles(SessionDiff::Alignment alignment)
+{
+    const juce::String patterns = "*" + CaptureFormat::getFileExtension() + ";*.wav;*.aif;*.aiff;*.flac";
+    auto flags = juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles;
+    
+    chooser = std::make_unique<juce::FileChooser>("Choose the reference (A) capture or bounce",
+                                                  CaptureFormat::getDefaultFolder(), patterns);
+    chooser->launchAsync(flags, [this, patterns, flags, alignment](const juce::FileChooser& fc) {
+        diffFileA = fc.getResult();
+        if (diffFileA == juce::File()) return;
+        
+        chooser = std::make_unique<juce::FileChooser>("Choose the revision (B) capture or bounce",
+                                                      diffFileA.getParentDirectory(), patterns);
+        chooser->launchAsync(flags, [this, alignment](const juce::FileChooser& fc2) {
+            auto fileB = fc2.getResult();
+            if (fileB != juce::File()) runDiff(diffFileA, fileB, alignment);
+        });
+    });
+}
+
+void SpectralImagerAudioProcessorEditor::runDiff(juce::File a, juce::File b, SessionDiff::Alignment alignment)
+{
+    if (diffCancel != nullptr) diffCancel->store(true);
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    diffCancel = cancel;
+    diffBtn.setButtonText("Diffing...");
+    
+    juce::Component::SafePointer<SpectralImagerAudioProcessorEditor> safeThis(this);
+    workers.addJob([a, b, alignment, cancel, safeThis] {
+        // Bounces are analyzed offline into temporary captures first
+        std::vector<std::unique_ptr<juce::TemporaryFile>> temps;
+        auto toCapture = [&](const juce::File& f) {
+            if (f.hasFileExtension(CaptureFormat::getFileExtension())) return f;
+            temps.push_back(std::make_unique<juce::TemporaryFile>(CaptureFormat::getFileExtension()));
+            auto out = temps.back()->getFile();
+            return OfflineCaptureAnalyzer::analyzeFile(f, out, 48, cancel.get()) ? out : juce::File();
+        };
+        
+        auto capA = toCapture(a);
+        auto capB = toCapture(b);
+        auto result = std::make_shared<SessionDiffResult>();
+        bool ok = capA != juce::File() && capB != juce::File()
+               && SessionDiff::compute(capA, capB, alignment, *result, cancel.get());
+        
+        if (cancel->load()) return;
+        juce::MessageManager::callAsync([safeThis, result, ok] {
+            if (safeThis == nullptr || safeThis->renderer == nullptr) return;
+            safeThis->renderer->setDiffOverlay(ok ? result : nullptr);
+            safeThis->diffBtn.setButtonText(ok ? "Live" : "Diff...");
+        });
+    });
+}
+
+void SpectralImagerAudioProcessorEditor::findConflicts()
+{
+    if (renderer == nullptr) return;
+    
+    // A click while a search runs cancels it
+    if (findCancel != nullptr)
+    {
+        findCancel->store(true);
+        findCancel = nullptr;
+        findBtn.setButtonText("Find...");
+        return;
+    }
+    
+    // While hits are loaded the button steps through them or returns to live
+    if (!conflictHits.empty())
+    {
+        const int numHits = static_cast<int>(conflictHits.size());
+        juce::PopupMenu menu;
+        menu.addItem(1, "Next hit", hitPos + 1 < numHits);
+        menu.addItem(2, "Previous hit", hitPos > 0);
+        menu.addSeparator();
+        menu.addItem(3, "Live");
+        menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&findBtn), [this](int choice) {
+            if (choice == 1) showHit(hitPos + 1);
+            else if (choice == 2) showHit(hitPos - 1);
+            else if (choice == 3) leaveReplay();
+        });
+        return;
+    }
+    
+    // Query the last finished recording, or let the user pick a capture
+    auto& recorder = proc.getRecorder();
+    if (!recorder.isRecording() && recorder.getFile().existsAsFile())
+    {
+        askConflictQuery(recorder.getFile());
+        return;
+    }
+    
+    chooser = std::make_unique<juce::FileChooser>("Choose a capture to search",
+                                                  CaptureFormat::getDefaultFolder(),
+                                                  "*" + CaptureFormat::getFileExtension());
+    chooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                         [this](const juce::FileChooser& fc) {
+        auto file = fc.getResult();
+        if (file != juce::File()) askConflictQuery(file);
+    });
+}
+
+void SpectralImagerAudioProcessorEditor::askConflictQuery(const juce::File& capture)
+{
+    // Its index only gets a frame count when the recording stops
+    auto& recorder = proc.getRecorder();
+    if (recorder.isRecording() && recorder.getFile() == capture)
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Find conflicts",
+                                               capture.getFileName() + " is still being recorded. Stop recording first.");
+        return;
+    }
+    
+    queryWindow = std::make_unique<juce::AlertWindow>("Find conflicts",
+        "Times when both tracks exceed the threshold in the same band of the range",
+        juce::MessageBoxIconType::NoIcon);
+    
+    juce::StringArray slots;
+    for (size_t i = 0; i < kMaxTracks; ++i)
+        slots.add("Slot " + juce::String(static_cast<int>(i) + 1));
+    
+    queryWindow->addComboBox("a", slots, "Track A");
+    queryWindow->addComboBox("b", slots, "Track B");
+    queryWindow->getComboBoxComponent("b")->setSelectedItemIndex(1);
+    queryWindow->addTextEditor("thr", "-20", "Threshold (dB)");
+    queryWindow->addTextEditor("lo", "20", "From (Hz)");
+    queryWindow->addTextEditor("hi", "120", "To (Hz)");
+    queryWindow->addButton("Find", 1, juce::KeyPress(juce::KeyPress::returnKey));
+    queryWindow->addButton("Cancel", 0, juce::KeyPress(juce::KeyPress::escapeKey));
+    
+    queryWindow->enterModalState(true, juce::ModalCallbackFunction::create([this, capture](int result) {
+        if (result != 1 || queryWindow == nullptr) return;
+        
+        ConflictQuery q;
+        q.trackA = queryWindow->getComboBoxComponent("a")->getSelectedItemIndex();
+        q.trackB = queryWindow->getComboBoxComponent("b")->getSelectedItemIndex();
+        q.thresholdDb = queryWindow->getTextEditorContents("thr").getFloatValue();
+        q.minHz = queryWindow->getTextEditorContents("lo").getFloatValue();
+        q.maxHz = queryWindow->getTextEditorContents("hi").getFloatValue();
+        if (q.minHz > q.maxHz) std::swap(q.minHz, q.maxHz);
+        if (q.trackA == q.trackB)
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Find conflicts",
+                                                   "Choose two different tracks.");
+            return;
+        }
+        runConflictQuery(capture, q);
+    }), false);
+}
+
+void SpectralImagerAudioProcessorEditor::runConflictQuery(const juce::File& capture, const ConflictQuery& q)
+{
+    // Loading may rebuild a missing index from the whole capture, so it runs off
+    // the message thread along with the query itself
+    auto cancel = std::make_shared<std::atomic<bool>>(false);
+    findCancel = cancel;
+    findBtn.setButtonText("Finding...");
+    
+    juce::Component::SafePointer<SpectralImagerAudioProcessorEditor> safeThis(this);
+    workers.addJob([capture, q, cancel, safeThis] {
+        CaptureIndex index;
+        bool ok = index.load(capture, cancel.get());
+        auto hits = ok ? index.findOverlaps(q, cancel.get()) : std::vector<ConflictHit>();
+        
+        if (cancel->load()) return;
+        juce::MessageManager::callAsync([safeThis, capture, cancel, ok, hits = std::move(hits)] {
+            if (safeThis == nullptr || cancel->load()) return;
+            auto& ed = *safeThis;
+            ed.findCancel = nullptr;
+            ed.findBtn.setButtonText("Find...");
+            
+            if (!ok)
+            {
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                       "Find conflicts", "Couldn't read " + capture.getFileName());
+                return;
+            }
+            if (hits.empty())
+            {
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon,
+                                                       "Find conflicts", "No overlaps found.");
+                return;
+            }
+            
+            ed.conflictCapture = capture;
+            ed.conflictHits = hits;
+            ed.showHit(0);
+        });
+    });
+}
+
+void SpectralImagerAudioProcessorEditor::leaveReplay()
+{
+    conflictHits.clear();
+    hitPos = -1;
+    if (renderer != nullptr) renderer->setReplayFrame(nullptr);
+    findBtn.setButtonText("Find...");
+}
+
+void SpectralImagerAudioProcessorEditor::showHit(int pos)
+{
+    if (renderer == nullptr || pos < 0 || pos >= static_cast<int>(conflictHits.size())) return;
+    hitPos = pos;
+    
+    const auto& hit = conflictHits[static_cast<size_t>(hitPos)];
+    auto frame = std::make_shared<CaptureFrame>();
+    CaptureReader reader;
+    if (reader.open(conflictCapture) && reader.seek(hit.startFrame) && reader.read(*frame))
+    {
+        auto toTime = [](uint32_t ms) {
+            return juce::String::formatted("%02d:%02d", static_cast<int>(ms / 60000), static_cast<int>((ms / 1000) % 60));
+        };
+        renderer->setReplayFrame(frame, toTime(hit.startMs) + " - " + toTime(hit.endMs)
+                                        + "  (hit " + juce::String(hitPos + 1) + "/"
+                                        + juce::String(static_cast<int>(conflictHits.size())) + ")");
+    }
+    
+    findBtn.setButtonText("Hit " + juce::String(hitPos + 1) + "/" + juce::String(static_cast<int>(conflictHits.size())));
+}
+
 void SpectralImagerAudioProcessorEditor::updateUI()
 {
     if (!uiInitialized) return;
@@ -400,12 +741,17 @@ void SpectralImagerAudioProcessorEditor::updateUI()
         {
             trackList = std::make_unique<TrackList>(proc.getSharedData());
             addAndMakeVisible(*trackList);
+            attachTrackList();
         }
         
         renderer->setVisible(true);
         trackList->setVisible(true);
         viewBox.setVisible(true);
         resetBtn.setVisible(true);
+        groupBtn.setVisible(true);
+        recordBtn.setVisible(true);
+        diffBtn.setVisible(true);
+        findBtn.setVisible(true);
         rangeSlider.setVisible(true);
         rangeLabel.setVisible(true);
         highResBtn.setVisible(false);  // Hide in receiver mode
@@ -417,6 +763,10 @@ void SpectralImagerAudioProcessorEditor::updateUI()
         if (trackList != nullptr) trackList->setVisible(false);
         viewBox.setVisible(false);
         resetBtn.setVisible(false);
+        groupBtn.setVisible(false);
+        recordBtn.setVisible(false);
+        diffBtn.setVisible(false);
+        findBtn.setVisible(false);
         rangeSlider.setVisible(false);
         rangeLabel.setVisible(false);
         highResBtn.setVisible(true);  // Show in sender mode
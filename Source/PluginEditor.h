@@ -32,8 +32,12 @@ public:
     explicit TrackList(ITrackDataProvider& d);
     ~TrackList() override;
     void paint(juce::Graphics&) override;
+    void mouseDown(const juce::MouseEvent& e) override;
+    std::function<void(int)> onTrackClicked;  // Slot index of the clicked dot
+    std::function<int(int)> clusterOf;        // Group of a slot (-1 = none), labelled on its dot
 private:
     void timerCallback() override;
+    juce::Rectangle<float> dotBounds(int index, int numDots) const;
     ITrackDataProvider& data;
     int count = 0;
 };
@@ -51,6 +55,16 @@ public:
 private:
     void timerCallback() override;
     void updateUI();
+    void attachTrackList();
+    void toggleRecording();
+    void chooseDiffFiles();
+    void pickDiffFiles(SessionDiff::Alignment alignment);
+    void runDiff(juce::File a, juce::File b, SessionDiff::Alignment alignment);
+    void findConflicts();
+    void askConflictQuery(const juce::File& capture);
+    void runConflictQuery(const juce::File& capture, const ConflictQuery& q);
+    void showHit(int pos);
+    void leaveReplay();
     
     SpectralImagerAudioProcessor& proc;
     
@@ -69,6 +83,25 @@ private:
     juce::Slider rangeSlider;
     juce::Label rangeLabel;
     juce::ToggleButton highResBtn{ "High Res" };
+    juce::ToggleButton groupBtn{ "Group" };
+    
+    // Session capture and diff
+    juce::TextButton recordBtn{ "Rec" };
+    juce::TextButton diffBtn{ "Diff..." };
+    std::unique_ptr<juce::FileChooser> chooser;
+    juce::File diffFileA;
+    std::shared_ptr<std::atomic<bool>> diffCancel;
+    
+    // Long jobs (offline analysis, diffs) run here; joined before the editor goes away
+    juce::ThreadPool workers{ 2 };
+    
+    // Conflict queries over a capture's index, stepped through in the replay view
+    juce::TextButton findBtn{ "Find..." };
+    std::unique_ptr<juce::AlertWindow> queryWindow;
+    juce::File conflictCapture;
+    std::shared_ptr<std::atomic<bool>> findCancel;
+    std::vector<ConflictHit> conflictHits;
+    int hitPos = -1;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> rangeAttachment;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> highResAttachment;
     
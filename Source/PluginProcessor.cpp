@@ -33,15 +33,10 @@ SpectralImagerAudioProcessor::SpectralImagerAudioProcessor()
         t.setColor(juce::Colour::fromHSV(static_cast<float>(i) / 8.0f, 0.85f, 1.0f, 1.0f));
     }
 #else
-    // Randomize Hue if this is a fresh instance (not yet loaded from state)
-    auto* hueParam = apvts.getParameter("hue");
-    float randomHue = juce::Random::getSystemRandom().nextFloat();
-    hueParam->setValueNotifyingHost(randomHue);
-    // Set the internal color variable immediately
-    color = juce::Colour::fromHSV(randomHue, 0.8f, 1.0f, 1.0f);
-
-    slot = sharedData->registerSender(instId);
-    if (slot >= 0) sharedData->getTrack(slot).setColor(color);
+    // No host notification or slot registration during construction (plugin scans,
+    // big templates): fresh instances get their random hue from assignInitialHue()
+    // and claim a slot in prepareToPlay().
+    color = juce::Colour::fromHSV(apvts.getRawParameterValue("hue")->load(), 0.8f, 1.0f, 1.0f);
     
     apvts.addParameterListener("mode", this);
     apvts.addParameterListener("hue", this);
@@ -60,7 +55,7 @@ SpectralImagerAudioProcessor::~SpectralImagerAudioProcessor()
     apvts.removeParameterListener("hue", this);
     apvts.removeParameterListener("sat", this);
     apvts.removeParameterListener("bri", this);
-    sharedData->unregisterSender(instId);
+    if (slot >= 0) sharedData->unregisterSender(instId);
 #endif
     apvts.removeParameterListener("range", this);
     apvts.removeParameterListener("highres", this);
@@ -122,11 +117,8 @@ void SpectralImagerAudioProcessor::setMode(PluginMode m)
     
     if (m == PluginMode::Sender)
     {
-        if (slot < 0)
-        {
-            slot = sharedData->registerSender(instId);
-            if (slot >= 0) sharedData->getTrack(slot).setColor(color);
-        }
+        // Before prepareToPlay() the slot is claimed there instead
+        if (prepared) registerSlot();
     }
     else
     {
@@ -138,6 +130,22 @@ void SpectralImagerAudioProcessor::setMode(PluginMode m)
     }
 }
 
+void SpectralImagerAudioProcessor::registerSlot()
+{
+    if (slot >= 0) return;
+    slot = sharedData->registerSender(instId);
+    if (slot >= 0) sharedData->getTrack(slot).setColor(color);
+}
+
+// Fresh instances get a random hue on first use (prepareToPlay or editor open) so
+// the parameter's default stays fixed for the host; loaded state takes precedence.
+void SpectralImagerAudioProcessor::assignInitialHue()
+{
+    if (stateLoaded.load() || hueAssigned.exchange(true)) return;
+    if (auto* hueParam = apvts.getParameter("hue"))
+        hueParam->setValueNotifyingHost(juce::Random::getSystemRandom().nextFloat());
+}
+
 void SpectralImagerAudioProcessor::setTrackColor(juce::Colour c)
 {
     color = c;
@@ -151,6 +159,7 @@ void SpectralImagerAudioProcessor::prepareToPlay(double sr, int block)
     bool highRes = apvts.getRawParameterValue("highres")->load() > 0.5f;
     int bands = highRes ? 48 : 24;
     numBands = bands;
+    prepared = true;
 
 #ifdef SI3D_16CH_UNIFIED
     for (auto& a : analyzers)
@@ -161,6 +170,8 @@ void SpectralImagerAudioProcessor::prepareToPlay(double sr, int block)
 #else
     analyzer.setNumBands(bands);
     analyzer.prepare(sr, block);
+    assignInitialHue();
+    if (mode == PluginMode::Sender) registerSlot();
 #endif
 }
 
@@ -222,8 +233,18 @@ void SpectralImagerAudioProcessor::processBlock(juce::AudioBuffer<float>& buf, j
             
             track.numBands.store(bands, std::memory_order_relaxed);
             for (int b = 0; b < bands; ++b)
+            {
                 track.setBand(static_cast<size_t>(b), res[static_cast<size_t>(b)].leftLevel, 
                              res[static_cast<size_t>(b)].rightLevel);
+                track.setPanHistogram(static_cast<size_t>(b), res[static_cast<size_t>(b)].panHist.data());
+            }
+            
+            const auto& peaks = analyzers[static_cast<size_t>(i)].getPeaks();
+            int numPeaks = analyzers[static_cast<size_t>(i)].getNumPeaks();
+            for (int p = 0; p < numPeaks; ++p)
+                track.setPeak(static_cast<size_t>(p), peaks[static_cast<size_t>(p)].frequency,
+                              peaks[static_cast<size_t>(p)].level, peaks[static_cast<size_t>(p)].pan);
+            track.numPeaks.store(numPeaks, std::memory_order_relaxed);
             
             sharedData.updateTimestamp(i);
         }
@@ -268,8 +289,18 @@ void SpectralImagerAudioProcessor::processBlock(juce::AudioBuffer<float>& buf, j
         int bands = analyzer.getNumBands();
         track.numBands.store(bands, std::memory_order_relaxed);
         for (int i = 0; i < bands; ++i)
+        {
             track.setBand(static_cast<size_t>(i), res[static_cast<size_t>(i)].leftLevel, 
                          res[static_cast<size_t>(i)].rightLevel);
+            track.setPanHistogram(static_cast<size_t>(i), res[static_cast<size_t>(i)].panHist.data());
+        }
+        
+        const auto& peaks = analyzer.getPeaks();
+        int numPeaks = analyzer.getNumPeaks();
+        for (int p = 0; p < numPeaks; ++p)
+            track.setPeak(static_cast<size_t>(p), peaks[static_cast<size_t>(p)].frequency,
+                          peaks[static_cast<size_t>(p)].level, peaks[static_cast<size_t>(p)].pan);
+        track.numPeaks.store(numPeaks, std::memory_order_relaxed);
         sharedData->updateTimestamp(slot);
     }
 #endif
@@ -290,6 +321,7 @@ void SpectralImagerAudioProcessor::setStateInformation(const void* data, int siz
         apvts.replaceState(juce::ValueTree::fromXml(*xml));
         
 #ifndef SI3D_16CH_UNIFIED
+        stateLoaded = true;
         float modeVal = apvts.getRawParameterValue("mode")->load();
         setMode(modeVal < 0.5f ? PluginMode::Sender : PluginMode::Receiver);
         setTrackColor(juce::Colour::fromHSV(apvts.getRawParameterValue("hue")->load(),
@@ -301,6 +333,9 @@ void SpectralImagerAudioProcessor::setStateInformation(const void* data, int siz
 
 juce::AudioProcessorEditor* SpectralImagerAudioProcessor::createEditor()
 {
+#ifndef SI3D_16CH_UNIFIED
+    assignInitialHue();
+#endif
     return new SpectralImagerAudioProcessorEditor(*this);
 }
 
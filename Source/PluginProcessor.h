@@ -9,6 +9,7 @@
 #include <JuceHeader.h>
 #include "SharedDataManager.h"
 #include "SpectralAnalyzer.h"
+#include "SessionCapture.h"
 
 enum class PluginMode { Sender, Receiver };
 
@@ -66,12 +67,18 @@ public:
         return *sharedData; 
 #endif
     }
+    SessionRecorder& getRecorder() { return recorder; }
     int getSlot() const { return slot; }
+    bool isPrepared() const { return prepared.load(); }
     
     juce::AudioProcessorValueTreeState apvts;
     
 private:
     juce::AudioProcessorValueTreeState::ParameterLayout createParams();
+#ifndef SI3D_16CH_UNIFIED
+    void registerSlot();
+    void assignInitialHue();
+#endif
     
 #ifdef SI3D_16CH_UNIFIED
     LocalDataManager sharedData;
@@ -80,12 +87,17 @@ private:
     juce::SharedResourcePointer<SharedDataManager> sharedData;
     SpectralAnalyzer analyzer;
 #endif
+    SessionRecorder recorder{ getSharedData() };
 
     PluginMode mode = PluginMode::Sender;
     juce::Colour color{ 0xFF00FFFF };
     float range = 90.0f;
     int numBands = 24;
     int slot = -1;
+    std::atomic<bool> prepared{ false };  // Read by the editor on the message thread
+#ifndef SI3D_16CH_UNIFIED
+    std::atomic<bool> stateLoaded{ false }, hueAssigned{ false };
+#endif
     uint64_t instId = 0;
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectralImagerAudioProcessor)
@@ -0,0 +1,172 @@
+/*
+  ==============================================================================
+    SessionCapture.h - Recording the receiver's frame stream to disk
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CaptureFormat.h"
+#include "CaptureIndex.h"
+#include "SpectralAnalyzer.h"
+#include <atomic>
+#include <memory>
+
+class CaptureWriter
+{
+public:
+    bool open(const juce::File& file)
+    {
+        close();
+        file.deleteFile();
+        stream = std::make_unique<juce::FileOutputStream>(file);
+        if (!stream->openedOk()) { stream.reset(); return false; }
+
+        stream->writeInt(CaptureFormat::kMagic);
+        stream->writeInt(CaptureFormat::kVersion);
+        stream->writeInt(CaptureFormat::kFrameRateHz);
+        stream->writeInt(CaptureFormat::kFrameBytes);
+        numFrames = 0;
+
+        // The query index is built alongside, one summary per block of frames
+        index.open(CaptureIndexFormat::fileFor(file));
+        return true;
+    }
+
+    bool isOpen() const { return stream != nullptr; }
+    int64_t getNumFrames() const { return numFrames; }
+
+    void write(const CaptureFrame& f)
+    {
+        if (stream == nullptr) return;
+
+        stream->writeInt(static_cast<int>(f.timeMs));
+        stream->write(f.numBands.data(), f.numBands.size());
+        for (size_t t = 0; t < kMaxTracks; ++t)
+        {
+            stream->write(f.left[t].data(), kMaxBands);
+            stream->write(f.right[t].data(), kMaxBands);
+        }
+        index.add(f);
+        ++numFrames;
+    }
+
+    void close()
+    {
+        if (stream != nullptr) stream->flush();
+        stream.reset();
+        index.close();
+    }
+
+private:
+    std::unique_ptr<juce::FileOutputStream> stream;
+    CaptureIndexBuilder index;
+    int64_t numFrames = 0;
+};
+
+// Records the shared track data at a fixed rate while enabled. Runs on the
+// message thread so file writes never touch the audio callback.
+class SessionRecorder : private juce::Timer
+{
+public:
+    explicit SessionRecorder(ITrackDataProvider& d) : data(d) {}
+    ~SessionRecorder() override { stop(); }
+
+    bool start(const juce::File& file)
+    {
+        stop();
+        if (!writer.open(file)) return false;
+
+        currentFile = file;
+        startMs = juce::Time::getMillisecondCounter();
+        startTimerHz(CaptureFormat::kFrameRateHz);
+        return true;
+    }
+
+    void stop()
+    {
+        stopTimer();
+        writer.close();
+    }
+
+    bool isRecording() const { return writer.isOpen(); }
+    juce::File getFile() const { return currentFile; }
+
+private:
+    void timerCallback() override
+    {
+        frame.captureFrom(data, juce::Time::getMillisecondCounter() - startMs);
+        writer.write(frame);
+    }
+
+    ITrackDataProvider& data;
+    CaptureWriter writer;
+    CaptureFrame frame;
+    juce::File currentFile;
+    uint32_t startMs = 0;
+};
+
+// Offline analysis of a bounce: runs the sender analyzer over an audio file and
+// writes a single-track capture (slot 0) at the capture frame rate.
+class OfflineCaptureAnalyzer
+{
+public:
+    static bool analyzeFile(const juce::File& audioFile, const juce::File& captureFile,
+                            int numBands = 48, const std::atomic<bool>* shouldExit = nullptr)
+    {
+        juce::AudioFormatManager formats;
+        formats.registerBasicFormats();
+        std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(audioFile));
+        if (reader == nullptr || reader->sampleRate <= 0.0) return false;
+
+        CaptureWriter writer;
+        if (!writer.open(captureFile)) return false;
+
+        constexpr int blockSize = 4096;
+        SpectralAnalyzer analyzer;
+        analyzer.setNumBands(numBands);
+        analyzer.prepare(reader->sampleRate, blockSize);
+
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        const auto samplesPerFrame = static_cast<int64_t>(reader->sampleRate / CaptureFormat::kFrameRateHz);
+        const bool mono = reader->numChannels < 2;
+
+        CaptureFrame frame;
+        std::array<float, kMaxBands> l{}, r{};
+        int64_t untilNextFrame = samplesPerFrame;
+
+        for (int64_t pos = 0; pos < reader->lengthInSamples; pos += blockSize)
+        {
+            if (shouldExit != nullptr && shouldExit->load()) return false;
+
+            int n = static_cast<int>(std::min<int64_t>(blockSize, reader->lengthInSamples - pos));
+            reader->read(&buffer, 0, n, pos, true, !mono);
+            const float* L = buffer.getReadPointer(0);
+            const float* R = mono ? L : buffer.getReadPointer(1);
+
+            // Feed the analyzer in frame-sized pieces so snapshots land on the frame grid
+            for (int done = 0; done < n;)
+            {
+                int chunk = static_cast<int>(std::min<int64_t>(n - done, untilNextFrame));
+                analyzer.process(L + done, R + done, chunk);
+                done += chunk;
+                untilNextFrame -= chunk;
+
+                if (untilNextFrame == 0)
+                {
+                    const auto& res = analyzer.getResults();
+                    for (size_t b = 0; b < kMaxBands; ++b) { l[b] = res[b].leftLevel; r[b] = res[b].rightLevel; }
+
+                    frame.timeMs = static_cast<uint32_t>(writer.getNumFrames() * 1000 / CaptureFormat::kFrameRateHz);
+                    frame.setTrack(0, analyzer.getNumBands(), l.data(), r.data());
+                    writer.write(frame);
+                    untilNextFrame = samplesPerFrame;
+                }
+            }
+        }
+
+        writer.close();
+        return true;
+    }
+};
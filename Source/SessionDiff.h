@@ -0,0 +1,217 @@
+/*
+  ==============================================================================
+    SessionDiff.h - Per-track, per-band dB difference between two captures
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SessionCapture.h"
+#include "BandResampler.h"
+#include <array>
+#include <atomic>
+#include <vector>
+
+// Summary of capture B relative to capture A. Tracks are matched by slot.
+struct SessionDiffResult
+{
+    std::array<int, kMaxTracks> numBands{};  // 0 = slot unused in both captures
+    // Over frames where either side is above kCompareFloorDb. The mean keeps the
+    // direction of a change; the RMS doesn't cancel when a band moved both ways.
+    std::array<std::array<float, kMaxBands>, kMaxTracks> meanDiffDb{};  // B - A
+    std::array<std::array<float, kMaxBands>, kMaxTracks> rmsDiffDb{};
+    std::array<std::array<float, kMaxBands>, kMaxTracks> leftB{}, rightB{};  // Mean linear levels of B
+    int64_t framesCompared = 0;
+    int offsetFrames = 0;  // Frame of A that lines up with B's first frame
+};
+
+// Streams both captures once (twice with energy alignment) holding only a couple
+// of frames and per-track accumulators, so memory doesn't grow with length apart
+// from the one-float-per-frame energy envelope used for alignment.
+class SessionDiff
+{
+public:
+    enum class Alignment { Time, EnergyCorrelation };
+
+    // Both sides are clamped here before subtracting, so silence vs. noise doesn't
+    // read as a huge change; it matches the bottom of the widest display range
+    static constexpr float kCompareFloorDb = -90.0f;
+
+    static bool compute(const juce::File& fileA, const juce::File& fileB, Alignment alignment,
+                        SessionDiffResult& result, const std::atomic<bool>* shouldExit = nullptr,
+                        int maxLagSeconds = 30)
+    {
+        CaptureReader a, b;
+        if (!a.open(fileA) || !b.open(fileB)) return false;
+
+        result = SessionDiffResult{};
+        if (alignment == Alignment::EnergyCorrelation)
+        {
+            auto envA = energyEnvelope(a, shouldExit);
+            auto envB = energyEnvelope(b, shouldExit);
+            result.offsetFrames = bestLag(envA, envB, maxLagSeconds * a.getFrameRate());
+        }
+
+        // Positive offset skips the start of A, negative skips the start of B
+        if (!a.seek(std::max(0, result.offsetFrames)) || !b.seek(std::max(0, -result.offsetFrames)))
+            return false;
+
+        std::array<std::array<float, kMaxBands>, kMaxTracks> sum{}, sumSq{};
+        std::array<std::array<int64_t, kMaxBands>, kMaxTracks> bandCount{};
+        std::array<int64_t, kMaxTracks> count{};
+        std::array<float, kMaxBands> scratch{}, levelA{}, levelB{}, diff{};
+        BandResampler resampler;
+        CaptureFrame fa, fb;
+
+        while (a.read(fa) && b.read(fb))
+        {
+            if (shouldExit != nullptr && shouldExit->load()) return false;
+
+            for (size_t t = 0; t < kMaxTracks; ++t)
+            {
+                int bandsA = fa.numBands[t], bandsB = fb.numBands[t];
+                if (bandsA == 0 && bandsB == 0) continue;
+
+                // Compare on the finer of the two layouts; keep the first grid seen for the slot
+                int grid = std::max(bandsA, bandsB);
+                if (result.numBands[t] == 0) result.numBands[t] = grid;
+                grid = result.numBands[t];
+
+                toGrid(fa, t, Side::Both, grid, resampler, scratch, levelA);
+                toGrid(fb, t, Side::Both, grid, resampler, scratch, levelB);
+
+                // Bands at the floor on both sides give a zero difference; they are
+                // left out of the per-band frame count so they don't dilute the mean
+                juce::FloatVectorOperations::max(levelA.data(), levelA.data(), kCompareFloorDb, grid);
+                juce::FloatVectorOperations::max(levelB.data(), levelB.data(), kCompareFloorDb, grid);
+                juce::FloatVectorOperations::subtract(diff.data(), levelB.data(), levelA.data(), grid);
+                juce::FloatVectorOperations::add(sum[t].data(), diff.data(), grid);
+                juce::FloatVectorOperations::addWithMultiply(sumSq[t].data(), diff.data(), diff.data(), grid);
+                for (size_t i = 0; i < static_cast<size_t>(grid); ++i)
+                    if (levelA[i] > kCompareFloorDb || levelB[i] > kCompareFloorDb)
+                        ++bandCount[t][i];
+
+                // B's own levels, so the diff view can be drawn without live input
+                toGrid(fb, t, Side::Left, grid, resampler, scratch, levelB);
+                addAsGain(result.leftB[t], levelB, grid);
+                toGrid(fb, t, Side::Right, grid, resampler, scratch, levelB);
+                addAsGain(result.rightB[t], levelB, grid);
+
+                ++count[t];
+            }
+            ++result.framesCompared;
+        }
+
+        for (size_t t = 0; t < kMaxTracks; ++t)
+        {
+            if (count[t] == 0) { result.numBands[t] = 0; continue; }
+
+            float inv = 1.0f / static_cast<float>(count[t]);
+            for (size_t i = 0; i < static_cast<size_t>(result.numBands[t]); ++i)
+            {
+                if (bandCount[t][i] > 0)
+                {
+                    float invBand = 1.0f / static_cast<float>(bandCount[t][i]);
+                    result.meanDiffDb[t][i] = sum[t][i] * invBand;
+                    result.rmsDiffDb[t][i] = std::sqrt(sumSq[t][i] * invBand);
+                }
+                result.leftB[t][i] *= inv;
+                result.rightB[t][i] *= inv;
+            }
+        }
+        return true;
+    }
+
+private:
+    enum class Side { Left, Right, Both };
+
+    // A slot's levels in dB on a `grid`-band layout. Inactive slots read as the floor.
+    static void toGrid(const CaptureFrame& f, size_t track, Side side, int grid, BandResampler& resampler,
+                       std::array<float, kMaxBands>& scratch, std::array<float, kMaxBands>& out)
+    {
+        int bands = f.numBands[track];
+        if (bands == 0)
+        {
+            std::fill(out.begin(), out.begin() + grid, CaptureFrame::kFloorDb);
+            return;
+        }
+
+        for (size_t i = 0; i < static_cast<size_t>(bands); ++i)
+        {
+            if (side == Side::Left)
+                scratch[i] = CaptureFrame::toDb(f.left[track][i]);
+            else if (side == Side::Right)
+                scratch[i] = CaptureFrame::toDb(f.right[track][i]);
+            else
+                scratch[i] = juce::Decibels::gainToDecibels(
+                    std::sqrt(0.5f * (CaptureFrame::toPower(f.left[track][i]) + CaptureFrame::toPower(f.right[track][i]))),
+                    CaptureFrame::kFloorDb);
+        }
+        resampler.processMean(bands, grid, scratch.data(), out.data());
+    }
+
+    static void addAsGain(std::array<float, kMaxBands>& acc, const std::array<float, kMaxBands>& db, int n)
+    {
+        for (size_t i = 0; i < static_cast<size_t>(n); ++i)
+            acc[i] += juce::Decibels::decibelsToGain(db[i], CaptureFrame::kFloorDb);
+    }
+
+    // Overall energy per frame in dB, used to line the two captures up
+    static std::vector<float> energyEnvelope(CaptureReader& reader, const std::atomic<bool>* shouldExit)
+    {
+        std::vector<float> env;
+        env.reserve(static_cast<size_t>(reader.getNumFrames()));
+        reader.seek(0);
+
+        CaptureFrame f;
+        while (reader.read(f))
+        {
+            if (shouldExit != nullptr && shouldExit->load()) break;
+
+            float e = 0.0f;
+            for (size_t t = 0; t < kMaxTracks; ++t)
+                for (size_t i = 0; i < f.numBands[t]; ++i)
+                    e += CaptureFrame::toPower(f.left[t][i]) + CaptureFrame::toPower(f.right[t][i]);
+            env.push_back(10.0f * std::log10(e + 1.0e-12f));
+        }
+        return env;
+    }
+
+    // Lag (in frames of A relative to B) maximizing the normalized cross-correlation
+    static int bestLag(const std::vector<float>& a, const std::vector<float>& b, int maxLag)
+    {
+        auto centred = [](const std::vector<float>& v) {
+            std::vector<float> out(v);
+            if (out.empty()) return out;
+            float mean = 0.0f;
+            for (auto x : out) mean += x;
+            mean /= static_cast<float>(out.size());
+            for (auto& x : out) x -= mean;
+            return out;
+        };
+        auto ca = centred(a), cb = centred(b);
+
+        int best = 0;
+        float bestScore = -1.0f;
+        for (int lag = -maxLag; lag <= maxLag; ++lag)
+        {
+            size_t startA = static_cast<size_t>(std::max(0, lag));
+            size_t startB = static_cast<size_t>(std::max(0, -lag));
+            if (startA >= ca.size() || startB >= cb.size()) continue;
+
+            size_t n = std::min(ca.size() - startA, cb.size() - startB);
+            float dot = 0.0f, ea = 0.0f, eb = 0.0f;
+            for (size_t i = 0; i < n; ++i)
+            {
+                float x = ca[startA + i], y = cb[startB + i];
+                dot += x * y;
+                ea += x * x;
+                eb += y * y;
+            }
+            float score = (ea > 0.0f && eb > 0.0f) ? dot / std::sqrt(ea * eb) : 0.0f;
+            if (score > bestScore) { bestScore = score; best = lag; }
+        }
+        return best;
+    }
+};
@@ -16,17 +16,31 @@ constexpr int kFFTOrder = 12;  // 4096-point FFT
 constexpr int kFFTSize = 1 << kFFTOrder;
 constexpr int kNumBins = kFFTSize / 2;
 constexpr size_t kMaxBands = 64;
+constexpr size_t kPanBuckets = 12;  // Per-band pan histogram, hard left .. hard right
+constexpr size_t kMaxPeaks = 8;     // Tonal peaks published per track
 
 // Per-band data
 struct BandInfo
 {
     std::atomic<float> leftLevel{ 0.0f };
     std::atomic<float> rightLevel{ 0.0f };
+    // Energy share per pan bucket, quantized to 8 bits and packed 4 per word
+    std::array<std::atomic<uint32_t>, kPanBuckets / 4> panHist{};
+};
+
+// Sinusoidal peak, loudest first
+struct PeakInfo
+{
+    std::atomic<float> frequency{ 0.0f };  // Hz, interpolated between bins
+    std::atomic<float> level{ 0.0f };      // Linear, same scaling as band levels
+    std::atomic<float> pan{ 0.0f };        // -1 = full left, +1 = full right
 };
 
 struct TrackData
 {
     std::array<BandInfo, kMaxBands> bands;
+    std::array<PeakInfo, kMaxPeaks> peaks;
+    std::atomic<int> numPeaks{ 0 };
     std::atomic<uint32_t> colorARGB{ 0xFF00FFFF };
     std::atomic<bool> isActive{ false };
     std::atomic<uint64_t> lastUpdate{ 0 };
@@ -51,6 +65,52 @@ struct TrackData
         }
     }
     
+    void getPanHistogram(size_t i, float* shares) const
+    {
+        if (i >= kMaxBands) return;
+        for (size_t w = 0; w < kPanBuckets / 4; ++w)
+        {
+            uint32_t packed = bands[i].panHist[w].load(std::memory_order_relaxed);
+            for (size_t k = 0; k < 4; ++k)
+                shares[w * 4 + k] = static_cast<float>((packed >> (k * 8)) & 0xFFu) / 255.0f;
+        }
+    }
+    
+    void setPanHistogram(size_t i, const float* shares)
+    {
+        if (i >= kMaxBands) return;
+        for (size_t w = 0; w < kPanBuckets / 4; ++w)
+        {
+            uint32_t packed = 0;
+            for (size_t k = 0; k < 4; ++k)
+            {
+                auto q = static_cast<uint32_t>(juce::jlimit(0, 255, juce::roundToInt(shares[w * 4 + k] * 255.0f)));
+                packed |= q << (k * 8);
+            }
+            bands[i].panHist[w].store(packed, std::memory_order_relaxed);
+        }
+    }
+    
+    void getPeak(size_t i, float& frequency, float& level, float& pan) const
+    {
+        if (i < kMaxPeaks)
+        {
+            frequency = peaks[i].frequency.load(std::memory_order_relaxed);
+            level = peaks[i].level.load(std::memory_order_relaxed);
+            pan = peaks[i].pan.load(std::memory_order_relaxed);
+        }
+    }
+    
+    void setPeak(size_t i, float frequency, float level, float pan)
+    {
+        if (i < kMaxPeaks)
+        {
+            peaks[i].frequency.store(frequency, std::memory_order_relaxed);
+            peaks[i].level.store(level, std::memory_order_relaxed);
+            peaks[i].pan.store(pan, std::memory_order_relaxed);
+        }
+    }
+    
     juce::Colour getColor() const { return juce::Colour(colorARGB.load(std::memory_order_relaxed)); }
     void setColor(juce::Colour c) { colorARGB.store(c.getARGB(), std::memory_order_relaxed); }
 };
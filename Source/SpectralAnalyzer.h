@@ -10,34 +10,39 @@
 #include "SharedDataManager.h"
 #include <array>
 #include <cmath>
+#include <memory>
 
 struct BandResult
 {
     float leftLevel = 0.0f;
     float rightLevel = 0.0f;
+    std::array<float, kPanBuckets> panHist{};  // Energy share per pan bucket, sums to 1
+};
+
+struct TonalPeak
+{
+    float frequency = 0.0f;
+    float level = 0.0f;
+    float pan = 0.0f;
 };
 
 class SpectralAnalyzer
 {
 public:
-    SpectralAnalyzer()
-        : fft(kFFTOrder),
-          window(static_cast<size_t>(kFFTSize), juce::dsp::WindowingFunction<float>::hann)
-    {
-        leftBuf.resize(static_cast<size_t>(kFFTSize), 0.0f);
-        rightBuf.resize(static_cast<size_t>(kFFTSize), 0.0f);
-        leftFFT.resize(static_cast<size_t>(kFFTSize * 2), 0.0f);
-        rightFFT.resize(static_cast<size_t>(kFFTSize * 2), 0.0f);
-        calcBands();
-    }
+    // FFT, window and buffers are allocated lazily in prepare() so that
+    // constructing an instance (e.g. during a host plugin scan) stays cheap
+    SpectralAnalyzer() { calcBands(); }
     
     void prepare(double sr, int)
     {
         sampleRate = sr;
+        allocate();
         calcBands();
         clear();
     }
     
+    bool isPrepared() const { return fft != nullptr; }
+    
     void setNumBands(int n)
     {
         activeBands = juce::jlimit(12, static_cast<int>(kMaxBands), n);
@@ -53,10 +58,13 @@ public:
         writePos = 0;
         sampleCount = 0;
         for (auto& b : results) b = BandResult{};
+        numPeaks = 0;
     }
     
     bool process(const float* L, const float* R, int numSamples)
     {
+        if (!isPrepared()) return false;
+        
         bool ready = false;
         for (int i = 0; i < numSamples; ++i)
         {
@@ -74,8 +82,27 @@ public:
     }
     
     const std::array<BandResult, kMaxBands>& getResults() const { return results; }
+    const std::array<TonalPeak, kMaxPeaks>& getPeaks() const { return peaks; }
+    int getNumPeaks() const { return numPeaks; }
     
 private:
+    void allocate()
+    {
+        if (isPrepared()) return;
+        
+        fft = std::make_unique<juce::dsp::FFT>(kFFTOrder);
+        window = std::make_unique<juce::dsp::WindowingFunction<float>>(
+            static_cast<size_t>(kFFTSize), juce::dsp::WindowingFunction<float>::hann);
+        leftBuf.assign(static_cast<size_t>(kFFTSize), 0.0f);
+        rightBuf.assign(static_cast<size_t>(kFFTSize), 0.0f);
+        leftFFT.assign(static_cast<size_t>(kFFTSize * 2), 0.0f);
+        rightFFT.assign(static_cast<size_t>(kFFTSize * 2), 0.0f);
+        binEnergy.assign(static_cast<size_t>(kNumBins), 0.0f);
+        binPan.assign(static_cast<size_t>(kNumBins), 0.0f);
+        binSum.assign(static_cast<size_t>(kNumBins), 0.0f);
+        binBucket.assign(static_cast<size_t>(kNumBins), 0);
+    }
+    
     void calcBands()
     {
         // Logarithmic frequency bands from 20Hz to 20kHz
@@ -94,6 +121,90 @@ private:
         }
     }
     
+    // Per-bin energy, pan and pan bucket for the whole spectrum as vector passes,
+    // so the band loop below only has to scatter into histograms
+    void computeBinPan()
+    {
+        using FVO = juce::FloatVectorOperations;
+        FVO::multiply(binEnergy.data(), leftFFT.data(), leftFFT.data(), kNumBins);
+        FVO::addWithMultiply(binEnergy.data(), rightFFT.data(), rightFFT.data(), kNumBins);
+        
+        // Same balance as the renderer: (r - l) / (l + r), -1 to +1
+        FVO::subtract(binPan.data(), rightFFT.data(), leftFFT.data(), kNumBins);
+        FVO::add(binSum.data(), leftFFT.data(), rightFFT.data(), kNumBins);
+        FVO::add(binSum.data(), 1.0e-9f, kNumBins);
+        FVO::divide(binPan.data(), binPan.data(), binSum.data(), kNumBins);
+        
+        // Bucket position in binSum, reused as scratch; only the integer cast stays scalar
+        constexpr float halfBuckets = static_cast<float>(kPanBuckets) * 0.5f;
+        FVO::add(binSum.data(), binPan.data(), 1.0f, kNumBins);
+        FVO::multiply(binSum.data(), halfBuckets, kNumBins);
+        FVO::min(binSum.data(), binSum.data(), static_cast<float>(kPanBuckets - 1), kNumBins);
+        for (size_t b = 0; b < static_cast<size_t>(kNumBins); ++b)
+            binBucket[b] = static_cast<uint8_t>(binSum[b]);
+    }
+    
+    // Top-N sinusoidal peaks of the combined L+R power spectrum. Local maxima are
+    // refined by fitting a parabola through the log power of the peak bin and its
+    // neighbours, giving sub-bin frequency and level accuracy.
+    void findPeaks()
+    {
+        constexpr float fftNorm = 4.0f / static_cast<float>(kFFTSize);
+        const float binHz = static_cast<float>(sampleRate) / static_cast<float>(kFFTSize);
+        const int firstBin = std::max(2, static_cast<int>(20.0f / binHz));
+        const int lastBin = std::min(kNumBins - 2, static_cast<int>(20000.0f / binHz));
+        
+        // Skip anything under -90 dBFS or 60 dB below the loudest bin
+        constexpr float minAmp = 3.16e-5f;
+        const float absFloor = 2.0f * (minAmp / fftNorm) * (minAmp / fftNorm);
+        const float loudest = juce::FloatVectorOperations::findMaximum(binEnergy.data() + firstBin, lastBin - firstBin + 1);
+        const float floorEnergy = std::max(absFloor, loudest * 1.0e-6f);
+        
+        numPeaks = 0;
+        for (int bin = firstBin; bin <= lastBin; ++bin)
+        {
+            size_t b = static_cast<size_t>(bin);
+            float e = binEnergy[b];
+            if (e <= floorEnergy || e <= binEnergy[b - 1] || e < binEnergy[b + 1]) continue;
+            
+            float lo = std::log(binEnergy[b - 1] + 1.0e-20f);
+            float mid = std::log(e);
+            float hi = std::log(binEnergy[b + 1] + 1.0e-20f);
+            float denom = lo - 2.0f * mid + hi;
+            float delta = denom < 0.0f ? juce::jlimit(-0.5f, 0.5f, 0.5f * (lo - hi) / denom) : 0.0f;
+            float peakEnergy = std::exp(mid - 0.25f * (lo - hi) * delta);
+            
+            float freq = (static_cast<float>(bin) + delta) * binHz;
+            
+            // Per-channel RMS amplitude with the band levels' pink compensation, so peaks
+            // and bars share the same vertical scale in the renderer
+            float pinkComp = juce::jlimit(0.3f, 3.0f, std::sqrt(freq / 1000.0f));
+            float level = std::sqrt(peakEnergy * 0.5f) * fftNorm * pinkComp;
+            
+            insertPeak({ freq, level, binPan[b] });
+        }
+    }
+    
+    // Keeps peaks sorted loudest first, dropping the quietest once full
+    void insertPeak(const TonalPeak& p)
+    {
+        int n = numPeaks;
+        if (n == static_cast<int>(kMaxPeaks))
+        {
+            if (p.level <= peaks[kMaxPeaks - 1].level) return;
+            --n;
+        }
+        
+        int pos = n;
+        while (pos > 0 && peaks[static_cast<size_t>(pos - 1)].level < p.level)
+        {
+            peaks[static_cast<size_t>(pos)] = peaks[static_cast<size_t>(pos - 1)];
+            --pos;
+        }
+        peaks[static_cast<size_t>(pos)] = p;
+        numPeaks = n + 1;
+    }
+    
     void analyze()
     {
         // Copy and window L/R channels separately
@@ -106,10 +217,12 @@ private:
         std::fill(leftFFT.begin() + kFFTSize, leftFFT.end(), 0.0f);
         std::fill(rightFFT.begin() + kFFTSize, rightFFT.end(), 0.0f);
         
-        window.multiplyWithWindowingTable(leftFFT.data(), static_cast<size_t>(kFFTSize));
-        window.multiplyWithWindowingTable(rightFFT.data(), static_cast<size_t>(kFFTSize));
-        fft.performFrequencyOnlyForwardTransform(leftFFT.data());
-        fft.performFrequencyOnlyForwardTransform(rightFFT.data());
+        window->multiplyWithWindowingTable(leftFFT.data(), static_cast<size_t>(kFFTSize));
+        window->multiplyWithWindowingTable(rightFFT.data(), static_cast<size_t>(kFFTSize));
+        fft->performFrequencyOnlyForwardTransform(leftFFT.data());
+        fft->performFrequencyOnlyForwardTransform(rightFFT.data());
+        computeBinPan();
+        findPeaks();
         
         // Normalization: 2/N for FFT, ~2 for Hann window correction
         constexpr float fftNorm = 4.0f / static_cast<float>(kFFTSize);
@@ -124,6 +237,7 @@ private:
             // Use interpolation to get unique values even when bins overlap
             float leftEnergy = 0.0f, rightEnergy = 0.0f;
             float totalWeight = 0.0f;
+            std::array<float, kPanBuckets> hist{};
             
             int startBin = std::max(1, static_cast<int>(std::floor(startBinF)));
             int endBin = std::min(kNumBins - 1, static_cast<int>(std::ceil(endBinF)));
@@ -146,6 +260,7 @@ private:
                     leftEnergy += lMag * lMag * weight;
                     rightEnergy += rMag * rMag * weight;
                     totalWeight += weight;
+                    hist[binBucket[b]] += binEnergy[b] * weight;
                 }
             }
             
@@ -171,15 +286,28 @@ private:
             // Smooth
             results[bandIdx].leftLevel = results[bandIdx].leftLevel * smooth + leftRMS * (1.0f - smooth);
             results[bandIdx].rightLevel = results[bandIdx].rightLevel * smooth + rightRMS * (1.0f - smooth);
+            
+            // Pan histogram as energy shares; silent bands keep their previous shape
+            float histTotal = 0.0f;
+            for (auto h : hist) histTotal += h;
+            if (histTotal > 0.0f)
+            {
+                auto& panHist = results[bandIdx].panHist;
+                for (size_t k = 0; k < kPanBuckets; ++k)
+                    panHist[k] = panHist[k] * smooth + (hist[k] / histTotal) * (1.0f - smooth);
+            }
         }
     }
     
-    juce::dsp::FFT fft;
-    juce::dsp::WindowingFunction<float> window;
-    std::vector<float> leftBuf, rightBuf, leftFFT, rightFFT;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::vector<float> leftBuf, rightBuf, leftFFT, rightFFT, binEnergy, binPan, binSum;
+    std::vector<uint8_t> binBucket;
     std::array<float, kMaxBands + 1> bandBinsFloat{};
     std::array<float, kMaxBands + 1> bandFreqs{};
     std::array<BandResult, kMaxBands> results{};
+    std::array<TonalPeak, kMaxPeaks> peaks{};
+    int numPeaks = 0;
     int writePos = 0, sampleCount = 0;
     int activeBands = 24;
     double sampleRate = 44100.0;
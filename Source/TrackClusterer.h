@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+    TrackClusterer.h - Online k-means grouping of tracks by spectrum and pan
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SharedDataManager.h"
+#include <array>
+#include <limits>
+
+// Groups tracks whose band profiles look alike so large sessions can be drawn as
+// a handful of aggregated bars. Each track is described by one feature vector
+// (per band: normalized level and level-weighted pan). Every frame each track
+// joins its nearest centroid and pulls it towards itself, so the cost per frame
+// is O(tracks x clusters x dims) with a small fixed cluster count.
+class TrackClusterer
+{
+public:
+    static constexpr size_t kMaxClusters = 4;  // Fixed k; clusters are seeded as tracks need them
+    static constexpr size_t kMaxDims = kMaxBands * 2;
+
+    using Features = std::array<float, kMaxDims>;
+
+    TrackClusterer() { assignment.fill(-1); }
+
+    void reset()
+    {
+        for (size_t c = 0; c < kMaxClusters; ++c) freeCluster(c);
+        assignment.fill(-1);
+    }
+
+    // features[t] holds `dims` values for every active track t
+    void update(const std::array<Features, kMaxTracks>& features,
+                const std::array<bool, kMaxTracks>& active, int dims)
+    {
+        // A grid change (e.g. a sender toggling High Res) invalidates every centroid
+        if (dims != currentDims)
+        {
+            currentDims = dims;
+            reset();
+        }
+        const auto d = static_cast<size_t>(dims);
+
+        for (auto& c : clusters) c.members = 0;
+
+        for (size_t t = 0; t < kMaxTracks; ++t)
+        {
+            if (!active[t]) { assignment[t] = -1; continue; }
+
+            const auto& x = features[t];
+            int best = -1;
+            float bestDist = std::numeric_limits<float>::max();
+            for (size_t c = 0; c < kMaxClusters; ++c)
+            {
+                if (!clusters[c].seeded) continue;
+                float dist = distance(x, clusters[c].centroid, d);
+                if (dist < bestDist) { bestDist = dist; best = static_cast<int>(c); }
+            }
+
+            // Hysteresis: only leave the current cluster for a clearly closer one, and
+            // only if it is still the group the track joined rather than a reseeded slot
+            int current = assignment[t];
+            if (current >= 0 && current != best && clusters[static_cast<size_t>(current)].seeded
+                && generations[static_cast<size_t>(current)] == assignedGenerations[t])
+            {
+                float currentDist = distance(x, clusters[static_cast<size_t>(current)].centroid, d);
+                if (currentDist <= bestDist * kSwitchRatio) { best = current; bestDist = currentDist; }
+            }
+
+            // Tracks far from every centroid seed a free cluster
+            if (best < 0 || bestDist > kSeedDistance)
+            {
+                int free = findFreeCluster();
+                if (free >= 0)
+                {
+                    auto& c = clusters[static_cast<size_t>(free)];
+                    std::copy(x.begin(), x.begin() + dims, c.centroid.begin());
+                    c.seeded = true;
+                    c.idleFrames = 0;
+                    ++generations[static_cast<size_t>(free)];
+                    best = free;
+                }
+            }
+
+            assignment[t] = best;
+            if (best < 0) continue;
+            assignedGenerations[t] = generations[static_cast<size_t>(best)];
+
+            auto& c = clusters[static_cast<size_t>(best)];
+            ++c.members;
+            for (size_t i = 0; i < d; ++i)
+                c.centroid[i] += kLearningRate * (x[i] - c.centroid[i]);
+        }
+
+        // Clusters left empty for a while become free for re-seeding
+        for (size_t c = 0; c < kMaxClusters; ++c)
+        {
+            auto& cl = clusters[c];
+            if (!cl.seeded) continue;
+            cl.idleFrames = cl.members > 0 ? 0 : cl.idleFrames + 1;
+            if (cl.idleFrames > kIdleFramesToFree) freeCluster(c);
+        }
+    }
+
+    // Cluster index for a track, or -1 if inactive / unassigned
+    int getCluster(size_t track) const { return track < kMaxTracks ? assignment[track] : -1; }
+
+    // Changes whenever a slot is freed or seeded with a new group, so state kept
+    // per slot (e.g. expanded in the view) can tell it no longer means the same tracks
+    uint32_t getGeneration(size_t c) const { return c < kMaxClusters ? generations[c] : 0; }
+
+private:
+    static constexpr float kLearningRate = 0.1f;
+    static constexpr float kSeedDistance = 0.03f;  // Mean squared difference per dimension
+    static constexpr float kSwitchRatio = 1.2f;
+    static constexpr int kIdleFramesToFree = 60;
+
+    struct Cluster
+    {
+        Features centroid{};
+        int members = 0;
+        int idleFrames = 0;
+        bool seeded = false;
+    };
+
+    static float distance(const Features& a, const Features& b, size_t dims)
+    {
+        float sum = 0.0f;
+        for (size_t i = 0; i < dims; ++i)
+        {
+            float diff = a[i] - b[i];
+            sum += diff * diff;
+        }
+        return dims > 0 ? sum / static_cast<float>(dims) : 0.0f;
+    }
+
+    void freeCluster(size_t c)
+    {
+        clusters[c] = Cluster{};
+        ++generations[c];
+    }
+
+    int findFreeCluster() const
+    {
+        for (size_t c = 0; c < kMaxClusters; ++c)
+            if (!clusters[c].seeded) return static_cast<int>(c);
+        return -1;
+    }
+
+    std::array<Cluster, kMaxClusters> clusters{};
+    std::array<int, kMaxTracks> assignment{};
+    std::array<uint32_t, kMaxClusters> generations{};
+    std::array<uint32_t, kMaxTracks> assignedGenerations{};  // Generation of the slot when the track joined it
+    int currentDims = 0;
+};